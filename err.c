@@ -1,4 +1,5 @@
 #include "err.h"
+#include "tx.h"
 
 static const char *_err_str_a[] = {
    "OK",
@@ -17,10 +18,11 @@ static const char *_err_str_a[] = {
 };
 
 void print_err(char* msg, ErrCode_e err) {
-   if (err < E_LAST_ELEM) {
-      printf("%s: %s.\n\r", msg, _err_str_a[err]);
-   }
-   else {
-      printf("%s: Unknown Error.\n\r", msg);
-   }
+   const char* const str_a[] = {
+      msg ? msg : "",
+      ": ",
+      (err < E_LAST_ELEM) ? _err_str_a[err] : "Unknown Error",
+      ".\n\r",
+   };
+   (void)Tx_WriteStr(str_a, sizeof(str_a) / sizeof(str_a[0]));
 }
@@ -1,8 +1,6 @@
 #ifndef ERR_H
 #define ERR_H
 
-#include <stdio.h>
-
 typedef enum ErrCode {
   E_OK = 0,
   E_NULL_PTR,
@@ -19,6 +17,8 @@ typedef enum ErrCode {
   E_LAST_ELEM,
 } ErrCode_e;
 
+/* Queue "msg: error.\n\r" on the default Tx instance, see tx.h. Never blocks, */
+/* the message is dropped if the ring is full. */
 void print_err(char* msg, ErrCode_e err);
 
 #endif
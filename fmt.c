@@ -0,0 +1,123 @@
+#include "fmt.h"
+
+/* Decimal digits are written two at a time from a table of the 100 pairs, */
+/* which halves the divisions, the costly part on cores without a divider. */
+static const char _dec_pairs[200] = {
+  '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+  '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+  '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+  '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+  '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+  '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+  '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+  '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+  '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+  '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9',
+};
+/* A hexadecimal digit is a shift and a mask, pairs would cost 512 bytes for */
+/* nothing. */
+static const char _hex_digits[16] = {
+  '0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F',
+};
+static const uint32_t _pow10_a[FMT_FIX_MAX_DECIMALS + 1] = {
+  1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u,
+};
+
+/* Number of decimal digits of data, at least one. */
+static inline uint8_t _dec_len(uint32_t data)
+{
+  uint8_t cnt = 1;
+  while((cnt < FMT_U32_MAX_LEN) && (data >= _pow10_a[cnt])) {
+    cnt++;
+  }
+  return cnt;
+}
+
+/* Write the cnt last decimal digits of data, ending right before end. */
+static inline void _dec_write(char* end, uint32_t data, uint8_t cnt)
+{
+  const char* pair;
+  for(; cnt >= 2; cnt -= 2) {
+    pair = &_dec_pairs[(data % 100u) * 2u];
+    data /= 100u;
+    *--end = pair[1];
+    *--end = pair[0];
+  }
+  if(cnt) {
+    *--end = (char)('0' + (data % 10u));
+  }
+}
+
+/* Common end of every format: size check, sign and terminator. */
+static inline ErrCode_e _fmt_dec(char* buf, size_t bufsz, uint8_t neg, uint32_t mag, uint8_t decimals, size_t* len)
+{
+  ErrCode_e ret = E_GENERIC;
+  uint32_t ipart = mag / _pow10_a[decimals];
+  uint8_t ilen = _dec_len(ipart);
+  size_t total = neg + ilen + (decimals ? 1u + decimals : 0u);
+  if(buf && (bufsz > total)) {
+    buf[0] = '-';
+    buf[total] = '\0';
+    if(decimals) {
+      _dec_write(&buf[total], mag - (ipart * _pow10_a[decimals]), decimals);
+      buf[total - decimals - 1u] = '.';
+    }
+    _dec_write(&buf[neg + ilen], ipart, ilen);
+    if(len) {
+      *len = total;
+    }
+    ret = E_OK;
+  } else {
+    ret = buf ? E_INV_SIZE : E_NULL_PTR;
+  }
+  return ret;
+}
+
+/* Magnitude of a signed value, INT32_MIN included. */
+static inline uint32_t _abs32(int32_t data)
+{
+  return (data < 0) ? (0u - (uint32_t)data) : (uint32_t)data;
+}
+
+ErrCode_e u32tostr(char* buf, size_t bufsz, uint32_t data, size_t* len)
+{
+  return _fmt_dec(buf, bufsz, 0, data, 0, len);
+}
+
+ErrCode_e i32tostr(char* buf, size_t bufsz, int32_t data, size_t* len)
+{
+  return _fmt_dec(buf, bufsz, (data < 0), _abs32(data), 0, len);
+}
+
+ErrCode_e fixtostr(char* buf, size_t bufsz, int32_t data, uint8_t decimals, size_t* len)
+{
+  ErrCode_e ret = E_INV_ARG;
+  if(decimals <= FMT_FIX_MAX_DECIMALS) {
+    ret = _fmt_dec(buf, bufsz, (data < 0), _abs32(data), decimals, len);
+  }
+  return ret;
+}
+
+ErrCode_e u32tohex(char* buf, size_t bufsz, uint32_t data, uint8_t width, size_t* len)
+{
+  ErrCode_e ret = E_GENERIC;
+  uint8_t cnt = 1;
+  while((cnt < FMT_HEX32_MAX_LEN) && (data >> (4u * cnt))) {
+    cnt++;
+  }
+  cnt = (width > cnt) ? width : cnt;
+  if(buf && (width <= FMT_HEX32_MAX_LEN) && (bufsz > cnt)) {
+    buf[cnt] = '\0';
+    if(len) {
+      *len = cnt;
+    }
+    while(cnt) {
+      buf[--cnt] = _hex_digits[data & 0xFu];
+      data >>= 4;
+    }
+    ret = E_OK;
+  } else {
+    ret = !buf ? E_NULL_PTR : (width > FMT_HEX32_MAX_LEN) ? E_INV_ARG : E_INV_SIZE;
+  }
+  return ret;
+}
@@ -0,0 +1,30 @@
+#ifndef FMT_H
+#define FMT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "err.h"
+
+/* Number formatting for replies, the inverse of strtou32/strtoi32 without */
+/* stdio. Each function writes a null-terminated string into buf, of bufsz */
+/* bytes terminator included, and stores its length in len unless len is */
+/* NULL. A buffer too small for the whole string returns E_INV_SIZE and is */
+/* left untouched. */
+
+#define FMT_U32_MAX_LEN (10) // Characters in "4294967295".
+#define FMT_I32_MAX_LEN (11) // Characters in "-2147483648".
+#define FMT_HEX32_MAX_LEN (8) // Characters in "FFFFFFFF".
+#define FMT_FIX_MAX_LEN (12) // Characters in "-2.147483648".
+#define FMT_FIX_MAX_DECIMALS (9)
+
+ErrCode_e u32tostr(char* buf, size_t bufsz, uint32_t data, size_t* len);
+ErrCode_e i32tostr(char* buf, size_t bufsz, int32_t data, size_t* len);
+/* Upper case hexadecimal without prefix, zero padded to width digits. A width */
+/* of 0 writes as few digits as needed, widths above 8 return E_INV_ARG. */
+ErrCode_e u32tohex(char* buf, size_t bufsz, uint32_t data, uint8_t width, size_t* len);
+/* Decimal fixed point: data counts units of 10^-decimals, so 12345 with 2 */
+/* decimals writes "123.45" and -5 writes "-0.05". Decimals above */
+/* FMT_FIX_MAX_DECIMALS return E_INV_ARG, 0 writes an integer. */
+ErrCode_e fixtostr(char* buf, size_t bufsz, int32_t data, uint8_t decimals, size_t* len);
+
+#endif
@@ -8,124 +8,395 @@
 #define STATIC static
 #endif
 
-typedef struct _Line_S {
-  uint8_t buff[LINE_BUFF_SIZE]; /* Buffer memory. */
-  uint8_t iscmplt; /* Message complete flag. */
-  uint16_t cnt; /* Number of elements in buffer. */
-  uint8_t isovrflwn; /* Signal overflow condition. */
-} Line_S;
+#define _idx_load(idx, order) LINE_IDX_LOAD(idx, order)
+#define _idx_store(idx, val, order) LINE_IDX_STORE(idx, val, order)
+
+/* Line lengths and queue positions must fit in their fields, see ucmd_config.h. */
+UCMD_STATIC_ASSERT((LINE_BUFF_SIZE >> (8 * sizeof(((Line_S*)0)->cnt))) == 0, "Line lengths do not fit in cnt.");
+UCMD_STATIC_ASSERT(LINE_QUEUE_DEPTH <= (1 << (8 * sizeof(LineIdx_t) - 1)), "Queue indexes do not fit in LineIdx_t.");
 
 /*-----------------------------------------------------------------------------
  *  Static global variables.
  *-----------------------------------------------------------------------------*/
-static volatile Line_S _line_s;
+static LineCtx_s _line_s; /* Instance behind the Line_ functions. */
+#if UCMD_LATENCY
+static Line_Clock _line_clock; /* Clock of the completion stamps. */
+#endif
 
 /*-----------------------------------------------------------------------------
  * Static function prototypes. 
  *-----------------------------------------------------------------------------*/
-static void _new_ch_callback (void*);
+static void _new_ch_callback (LineCtx_s*, uint8_t);
 STATIC inline uint8_t _is_eol_ch(uint8_t);
-static inline void _add_new_ch(uint8_t);
+static inline void _add_new_ch(Line_S*, uint8_t);
+static inline void _flush_line(Line_S*);
+static inline uint8_t _queue_cnt(LineCtx_s*);
+static inline void _line_cmplt(LineCtx_s*, Line_S*);
+static inline void _line_ovrflw(LineCtx_s*, Line_S*);
+
+/* Line being received. Only valid while the queue is not full. */
+#define _wr_line(ctx) (&(ctx)->slot[_idx_load((ctx)->head, relaxed) % LINE_QUEUE_DEPTH])
+/* Oldest line in the queue. It is the line being received if none is complete. */
+#define _rd_line(ctx) (&(ctx)->slot[_idx_load((ctx)->tail, relaxed) % LINE_QUEUE_DEPTH])
+
+static inline void _add_new_ch ( Line_S* line, uint8_t newchar )
+{
+  line->buff[line->cnt] = newchar;
+  line->cnt++;
+  return;
+}
 
-static inline void _add_new_ch ( uint8_t newchar )
+static inline void _flush_line ( Line_S* line )
 {
-  _line_s.buff[_line_s.cnt] = newchar;
-  _line_s.cnt++;
+  memset(line->buff, 0, sizeof(line->buff));
+  line->iscmplt = false;
+  line->cnt = 0;
   return;
 }
 
+/* Terminate the line, hand it over to the consumer and let the application know. */
+static inline void _line_cmplt ( LineCtx_s* ctx, Line_S* line )
+{
+  line->iscmplt = true;
+  _add_new_ch(line, LINE_NULL_CHAR);
+#if UCMD_LATENCY
+  /* Published with the line by the release below. */
+  line->stamp = _line_clock ? _line_clock() : 0u;
+#endif
+  _idx_store(ctx->head, (uint8_t)(_idx_load(ctx->head, relaxed) + 1), release);
+  if(ctx->oncmplt) {
+    ctx->oncmplt(ctx->oncmplt_arg);
+  }
+}
+
+static inline void _line_ovrflw ( LineCtx_s* ctx, Line_S* line )
+{
+  ctx->isovrflwn = true;
+  _flush_line(line);
+  if(ctx->onovrflw) {
+    ctx->onovrflw(ctx->onovrflw_arg);
+  }
+}
+
+/* Both sides see a count that is at most stale in the safe direction: the */
+/* producer may see a slot still in use, the consumer may miss a new line. */
+static inline uint8_t _queue_cnt ( LineCtx_s* ctx )
+{
+  return (uint8_t)(_idx_load(ctx->head, acquire) - _idx_load(ctx->tail, acquire));
+}
+
 STATIC inline uint8_t _is_eol_ch (uint8_t ch)
 {
   return (ch == LINE_CHAR_LF) ||
          (ch == LINE_CHAR_CR);
 }
 
-static void _new_ch_callback (void* params)
+/* First end of line character in the block, or NULL. */
+static inline const uint8_t* _find_eol ( const uint8_t* data, size_t len )
 {
-  uint8_t newchar = *((uint8_t*)params);
+  const uint8_t* cr = memchr(data, LINE_CHAR_CR, len);
+  const uint8_t* lf = memchr(data, LINE_CHAR_LF, cr ? (size_t)(cr - data) : len);
+  return lf ? lf : cr;
+}
+
+/* Number of leading characters that an empty line ignores. */
+static inline size_t _skip_blank ( const uint8_t* data, size_t len )
+{
+  size_t i = 0;
+  while((i < len) && (_is_eol_ch(data[i]) || (data[i] == LINE_CHAR_SPACE))) {
+    i++;
+  }
+  return i;
+}
 
+static void _new_ch_callback (LineCtx_s* ctx, uint8_t newchar)
+{
+  Line_S* line;
+
+  /* A line that started while the queue was full is dropped as a whole, even */
+  /* if a slot is released before its end of line character is received. */
+  if(ctx->isdropping) {
+    ctx->isdropping = !_is_eol_ch(newchar);
+    return;
+  }
+  if(_queue_cnt(ctx) >= LINE_QUEUE_DEPTH) {
+    if(!_is_eol_ch(newchar) && (newchar != LINE_CHAR_SPACE)) {
+      ctx->isdropping = true;
+      ctx->drops++;
+    }
+    return;
+  }
+
+  line = _wr_line(ctx);
   /* If buffer is empty and end of line character received, just ignore it and return. */
-  /* If an end character is received after the message is complete, ignore it and return. */
   /* If buffer is overflown, a character cannot be normally added. Wait for recovery conditions. */
-  if(!Line_BuffIsFull() &&
-     !(Line_BuffIsEmpty() && (_is_eol_ch(newchar) || (newchar == LINE_CHAR_SPACE))) &&
-     ! Line_BuffIsOvrFlwn()) {
+  if(!(line->cnt >= LINE_BUFF_SIZE) &&
+     !((line->cnt == 0) && (_is_eol_ch(newchar) || (newchar == LINE_CHAR_SPACE))) &&
+     ! ctx->isovrflwn) {
 
     /* If buffer is not empty and end of message character received, signal a message */
     /* complete so that command can be processed. Also replace end character with */
     /* null character so that it can be processed as a null-terminated string. */
-    if(!Line_BuffIsEmpty() && _is_eol_ch(newchar)) {
-      _line_s.iscmplt = true;
-      _add_new_ch(LINE_NULL_CHAR);
-      /* Call string parser. */
+    /* The line is then handed over to the consumer and reception continues on */
+    /* the next slot. */
+    if((line->cnt != 0) && _is_eol_ch(newchar)) {
+      _line_cmplt(ctx, line);
     }
 
     /* If this is the last character that fits into buffer and no end of message caharacter */
     /* has been received, then signal overflow condition. */
     /* When an overflow condition has happened, flush the buffer and ignore all characters */
     /* until a new end of line has been received as previous command was invalid. */
-    else if(Line_GetCnt() == (LINE_BUFF_SIZE - 1)) {
-      _line_s.isovrflwn = true;
-      Line_FlushBuff();
+    else if(line->cnt == (LINE_BUFF_SIZE - 1)) {
+      _line_ovrflw(ctx, line);
 
     } else {
       /* This is a valid char and command is not complete. Add it to buffer. */
-      _add_new_ch(newchar);
+      _add_new_ch(line, newchar);
     }
-  } else if (Line_BuffIsOvrFlwn() && _is_eol_ch(newchar)) {
+  } else if (ctx->isovrflwn && _is_eol_ch(newchar)) {
     /* Are conditions valid to recover from overflow? */
     /* Recovers from overflow event when eond of line character is received. */
-    _line_s.isovrflwn = false;
-    Line_FlushBuff();
+    ctx->isovrflwn = false;
+    _flush_line(line);
   }
   return;
 }
 
-void Line_Init (void) {
-  Line_FlushBuff();
-  _line_s.isovrflwn = false;
+/* Block version of _new_ch_callback. Each branch consumes characters in the */
+/* same state, so that results are exactly those of the per-character path. */
+static void _new_chars_callback (LineCtx_s* ctx, const uint8_t* data, size_t len)
+{
+  const uint8_t* eol;
+  size_t seg;
+  size_t room;
+  Line_S* line;
+
+  while(len) {
+    if(ctx->isdropping || ctx->isovrflwn) {
+      /* Everything up to the next end of line character is discarded. */
+      eol = _find_eol(data, len);
+      if(!eol) {
+        return;
+      }
+      if(ctx->isdropping) {
+        ctx->isdropping = false;
+      } else {
+        ctx->isovrflwn = false;
+        _flush_line(_wr_line(ctx));
+      }
+      seg = (size_t)(eol - data) + 1;
+    } else if(_queue_cnt(ctx) >= LINE_QUEUE_DEPTH) {
+      seg = _skip_blank(data, len);
+      if(seg < len) {
+        ctx->isdropping = true;
+        ctx->drops++;
+        seg++;
+      }
+    } else if((_wr_line(ctx)->cnt == 0) && _skip_blank(data, len)) {
+      /* Leading blanks are ignored, as on the per-character path. */
+      seg = _skip_blank(data, len);
+    } else {
+      line = _wr_line(ctx);
+      eol = _find_eol(data, len);
+      seg = eol ? (size_t)(eol - data) : len;
+      room = (LINE_BUFF_SIZE - 1) - line->cnt;
+      if(seg > room) {
+        /* The character after the last one that fits overflows the buffer. */
+        _line_ovrflw(ctx, line);
+        seg = room + 1;
+      } else {
+        memcpy(&line->buff[line->cnt], data, seg);
+        line->cnt += seg;
+        if(eol) {
+          _line_cmplt(ctx, line);
+          seg++;
+        }
+      }
+    }
+    data += seg;
+    len -= seg;
+  }
+}
+
+void LineCtx_Init (LineCtx_s* ctx) {
+  uint8_t idx;
+  /* Reception is stopped, both sides of the queue are reset. */
+  for(idx = 0; idx < LINE_QUEUE_DEPTH; idx++) {
+    _flush_line(&ctx->slot[idx]);
+  }
+  _idx_store(ctx->head, 0, relaxed);
+  _idx_store(ctx->tail, 0, release);
+  ctx->isovrflwn = false;
+  ctx->isdropping = false;
+  ctx->drops = 0;
+  ctx->dmapos = 0;
+  ctx->oncmplt = NULL;
+  ctx->onovrflw = NULL;
   /* Connect char rx interrupt to new char handle function. */
 }
 
+void LineCtx_SetCmpltCallback(LineCtx_s* ctx, Line_Callback callback, void* arg) {
+  ctx->oncmplt_arg = arg;
+  ctx->oncmplt = callback;
+}
+
+void LineCtx_SetOvrFlwCallback(LineCtx_s* ctx, Line_Callback callback, void* arg) {
+  ctx->onovrflw_arg = arg;
+  ctx->onovrflw = callback;
+}
+
+
+uint8_t LineCtx_BuffIsFull (LineCtx_s* ctx)
+{
+  return _rd_line(ctx)->cnt >= LINE_BUFF_SIZE;
+}
 
-uint8_t Line_BuffIsFull (void)
+void LineCtx_GetBuff (LineCtx_s* ctx, uint8_t* buff)
 {
-  return _line_s.cnt >= LINE_BUFF_SIZE;
+  memcpy((void*)buff, (void*)_rd_line(ctx)->buff, LINE_BUFF_SIZE);
 }
 
-void Line_GetBuff (uint8_t* buff)
+void LineCtx_PopBuff (LineCtx_s* ctx, uint8_t* buff)
 {
-  memcpy((void*)buff, (void*)_line_s.buff, sizeof(_line_s.buff));
+  const uint8_t* line = LineCtx_AcquireBuff(ctx);
+  if(line) {
+    memcpy((void*)buff, (void*)line, LINE_BUFF_SIZE);
+    LineCtx_ReleaseBuff(ctx);
+  }
 }
 
-uint8_t Line_BuffIsEmpty (void)
+const uint8_t* LineCtx_AcquireBuff (LineCtx_s* ctx)
 {
-  return _line_s.cnt == 0;
+  return _queue_cnt(ctx) ? _rd_line(ctx)->buff : NULL;
 }
 
-uint8_t Line_GetCnt (void)
+void LineCtx_ReleaseBuff (LineCtx_s* ctx)
 {
-  return _line_s.cnt;
+  if(_queue_cnt(ctx)) {
+    /* The slot is cleared before it is given back to the producer. */
+    _flush_line(_rd_line(ctx));
+    _idx_store(ctx->tail, (uint8_t)(_idx_load(ctx->tail, relaxed) + 1), release);
+  }
 }
 
-void Line_FlushBuff (void) {
-  memset((void*)_line_s.buff, 0, sizeof(_line_s.buff));
-  _line_s.iscmplt = false;
-  _line_s.cnt = 0;
+uint8_t LineCtx_BuffIsEmpty (LineCtx_s* ctx)
+{
+  return _rd_line(ctx)->cnt == 0;
+}
+
+uint16_t LineCtx_GetCnt (LineCtx_s* ctx)
+{
+  return _rd_line(ctx)->cnt;
+}
+
+void LineCtx_FlushBuff (LineCtx_s* ctx) {
+  /* Consumer side only: each slot is cleared before tail gives it back, as the */
+  /* producer appends at its count. */
+  while(_queue_cnt(ctx)) {
+    LineCtx_ReleaseBuff(ctx);
+  }
   return;
 }
 
-uint8_t Line_IsCmplt (void)
+uint8_t LineCtx_IsCmplt (LineCtx_s* ctx)
+{
+  return _queue_cnt(ctx) != 0;
+}
+
+uint8_t LineCtx_BuffIsOvrFlwn (LineCtx_s* ctx)
+{
+  return ctx->isovrflwn;
+}
+
+uint8_t LineCtx_GetQueueCnt (LineCtx_s* ctx)
+{
+  return _queue_cnt(ctx);
+}
+
+uint16_t LineCtx_GetDropCnt (LineCtx_s* ctx)
 {
-  return _line_s.iscmplt;
+  return ctx->drops;
 }
 
-uint8_t Line_BuffIsOvrFlwn ( void )
+#if UCMD_LATENCY
+uint8_t LineCtx_GetStamp (LineCtx_s* ctx, uint32_t* stamp)
 {
-  return _line_s.isovrflwn;
+  uint8_t ret = _queue_cnt(ctx) != 0;
+  if(ret) {
+    *stamp = _rd_line(ctx)->stamp;
+  }
+  return ret;
+}
+#endif
+
+void LineCtx_AddChar(LineCtx_s* ctx, char ch) {
+  _new_ch_callback(ctx, (uint8_t)ch);
 }
 
-void Line_AddChar(char ch) {
-  uint8_t tmp = ch;
-  _new_ch_callback((void*)&tmp);
+void LineCtx_AddChars(LineCtx_s* ctx, const uint8_t* data, size_t len) {
+  if(data) {
+    _new_chars_callback(ctx, data, len);
+  }
+}
+
+void LineCtx_DmaRx(LineCtx_s* ctx, const uint8_t* dmabuf, size_t bufsz, size_t pos) {
+  size_t last = ctx->dmapos;
+  if(dmabuf && (pos <= bufsz) && (last < bufsz)) {
+    if(pos >= last) {
+      _new_chars_callback(ctx, &dmabuf[last], pos - last);
+    } else {
+      /* The DMA wrapped around since the last call. */
+      _new_chars_callback(ctx, &dmabuf[last], bufsz - last);
+      _new_chars_callback(ctx, dmabuf, pos);
+    }
+    ctx->dmapos = (pos == bufsz) ? 0 : pos;
+  }
 }
+
+/*-----------------------------------------------------------------------------
+ *  Default instance.
+ *-----------------------------------------------------------------------------*/
+LineCtx_s* Line_GetCtx (void) { return &_line_s; }
+
+void Line_Init (void) { LineCtx_Init(&_line_s); }
+
+void Line_SetCmpltCallback(Line_Callback callback, void* arg) { LineCtx_SetCmpltCallback(&_line_s, callback, arg); }
+
+void Line_SetOvrFlwCallback(Line_Callback callback, void* arg) { LineCtx_SetOvrFlwCallback(&_line_s, callback, arg); }
+
+uint8_t Line_BuffIsFull (void) { return LineCtx_BuffIsFull(&_line_s); }
+
+void Line_GetBuff (uint8_t* buff) { LineCtx_GetBuff(&_line_s, buff); }
+
+void Line_PopBuff (uint8_t* buff) { LineCtx_PopBuff(&_line_s, buff); }
+
+const uint8_t* Line_AcquireBuff (void) { return LineCtx_AcquireBuff(&_line_s); }
+
+void Line_ReleaseBuff (void) { LineCtx_ReleaseBuff(&_line_s); }
+
+uint8_t Line_BuffIsEmpty (void) { return LineCtx_BuffIsEmpty(&_line_s); }
+
+uint16_t Line_GetCnt (void) { return LineCtx_GetCnt(&_line_s); }
+
+void Line_FlushBuff (void) { LineCtx_FlushBuff(&_line_s); }
+
+uint8_t Line_IsCmplt (void) { return LineCtx_IsCmplt(&_line_s); }
+
+uint8_t Line_BuffIsOvrFlwn ( void ) { return LineCtx_BuffIsOvrFlwn(&_line_s); }
+
+uint8_t Line_GetQueueCnt (void) { return LineCtx_GetQueueCnt(&_line_s); }
+
+uint16_t Line_GetDropCnt (void) { return LineCtx_GetDropCnt(&_line_s); }
+
+#if UCMD_LATENCY
+void Line_SetClock (Line_Clock clock) { _line_clock = clock; }
+
+uint8_t Line_GetStamp (uint32_t* stamp) { return LineCtx_GetStamp(&_line_s, stamp); }
+#endif
+
+void Line_AddChar(char ch) { LineCtx_AddChar(&_line_s, ch); }
+
+void Line_AddChars(const uint8_t* data, size_t len) { LineCtx_AddChars(&_line_s, data, len); }
+
+void Line_DmaRx(const uint8_t* dmabuf, size_t bufsz, size_t pos) { LineCtx_DmaRx(&_line_s, dmabuf, bufsz, pos); }
@@ -1,4 +1,9 @@
+#ifndef LINE_H
+#define LINE_H
+
 #include <stdint.h>
+#include <stddef.h>
+#include "ucmd_config.h"
 
 /*-----------------------------------------------------------------------------
  *  Macro detiniftions.
@@ -16,8 +21,22 @@
 #define LINE_CHAR_Z (90)
 #define LINE_CHAR_a (97)
 #define LINE_CHAR_z (122)
-#define LINE_MAX_STR_LEN (64)
-#define LINE_BUFF_SIZE (LINE_MAX_STR_LEN + 1)
+/* LINE_MAX_STR_LEN, LINE_BUFF_SIZE and LINE_QUEUE_DEPTH come from ucmd_config.h. */
+
+/* The queue is a single producer (receive interrupt) single consumer (main loop) */
+/* ring. With C11 atomics it is lock-free and neither side masks interrupts. Other */
+/* compilers, or LINE_NO_ATOMICS, fall back to volatile indices and the consumer */
+/* keeps its critical section. */
+#if !defined(LINE_NO_ATOMICS) && defined(__STDC_VERSION__) && \
+    (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__)
+#define LINE_LOCK_FREE (1)
+#else
+#define LINE_LOCK_FREE (0)
+#endif
+
+#if LINE_LOCK_FREE
+#include <stdatomic.h>
+#endif
 
 
 /*-----------------------------------------------------------------------------
@@ -27,16 +46,98 @@
 /*-----------------------------------------------------------------------------
  * Type definitions. 
  *-----------------------------------------------------------------------------*/
+/* Hook called from the receiving context (usually the receive interrupt), to */
+/* signal a semaphore, set an event flag or wake the main loop up. */
 typedef void (*Line_Callback)(void* arg);
 
+#if UCMD_LATENCY
+/* Free running tick counter, read when a line is completed. */
+typedef uint32_t (*Line_Clock)(void);
+#endif
+
+#if LINE_LOCK_FREE
+typedef atomic_uint_least8_t LineIdx_t;
+#else
+typedef volatile uint8_t LineIdx_t;
+#endif
+
+/* Queue index accesses, also used by other single producer single consumer */
+/* queues fed from the receive interrupt. */
+#if LINE_LOCK_FREE
+#define LINE_IDX_LOAD(idx, order) atomic_load_explicit(&(idx), memory_order_##order)
+#define LINE_IDX_STORE(idx, val, order) atomic_store_explicit(&(idx), (val), memory_order_##order)
+#else
+/* Byte accesses are atomic on single core targets. Only the compiler has to be */
+/* kept from moving buffer accesses across the index updates. */
+#if defined(__GNUC__)
+#define LINE_COMPILER_BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+#define LINE_COMPILER_BARRIER()
+#endif
+#define LINE_IDX_LOAD(idx, order) Line_IdxLoad(&(idx))
+#define LINE_IDX_STORE(idx, val, order) do { LINE_COMPILER_BARRIER(); (idx) = (val); } while(0)
+static inline uint8_t Line_IdxLoad(LineIdx_t* idx) {
+  uint8_t val = *idx;
+  LINE_COMPILER_BARRIER();
+  return val;
+}
+#endif
+
+typedef struct _Line_S {
+  uint8_t buff[LINE_BUFF_SIZE]; /* Buffer memory. */
+  uint8_t iscmplt; /* Message complete flag. */
+  uint16_t cnt; /* Number of elements in buffer. */
+#if UCMD_LATENCY
+  uint32_t stamp; /* Clock ticks when the line was completed. */
+#endif
+} Line_S;
+
+/* One receive channel. Storage is provided by the caller, members are private. */
+/* A slot belongs to the producer from the moment the consumer publishes tail past */
+/* it, and to the consumer from the moment the producer publishes head past it. */
+typedef struct LineCtx {
+  Line_S slot[LINE_QUEUE_DEPTH]; /* Lines, filled and consumed in order. */
+  LineIdx_t head; /* Number of lines completed. Only the producer writes it. */
+  LineIdx_t tail; /* Number of lines consumed. Only the consumer writes it. */
+  volatile uint8_t isovrflwn; /* Signal overflow condition. */
+  uint8_t isdropping; /* Current line is being dropped as the queue is full. */
+  volatile uint16_t drops; /* Number of lines dropped. */
+  size_t dmapos; /* Read position in the circular DMA buffer. */
+  Line_Callback oncmplt; /* Line complete hook. */
+  void* oncmplt_arg;
+  Line_Callback onovrflw; /* Line overflow hook. */
+  void* onovrflw_arg;
+} LineCtx_s;
+
 /* 
  * ===  FUNCTION  ======================================================================
  *         Name:  Line_Init
- *  Description:  Initialize Line module.
+ *  Description:  Initialize Line module. Resets both sides of the queue, so it must
+                  be called while reception is stopped.
  * =====================================================================================
  */
 void Line_Init(void);
 
+/* 
+ * ===  FUNCTION  ======================================================================
+ *         Name:  Line_SetCmpltCallback
+ *  Description:  Register a hook called each time a line is complete and queued, so
+                  that the application can sleep until there is a line to process.
+                  NULL unregisters it. Line_Init clears registered hooks, register
+                  them after it and before characters start to arrive.
+ * =====================================================================================
+ */
+void Line_SetCmpltCallback(Line_Callback callback, void* arg);
+
+/* 
+ * ===  FUNCTION  ======================================================================
+ *         Name:  Line_SetOvrFlwCallback
+ *  Description:  Register a hook called each time a line overflows the buffer.
+                  NULL unregisters it. Line_Init clears registered hooks.
+ * =====================================================================================
+ */
+void Line_SetOvrFlwCallback(Line_Callback callback, void* arg);
+
 /* 
  * ===  FUNCTION  ======================================================================
  *         Name:  Line_AddChar
@@ -45,6 +146,29 @@ void Line_Init(void);
  */
 void Line_AddChar(char ch);
 
+/* 
+ * ===  FUNCTION  ======================================================================
+ *         Name:  Line_AddChars
+ *  Description:  Add a block of characters to the buffer. Same as calling Line_AddChar
+                  on each of them, but end of line characters are searched for over the
+                  whole block and the segments between them are copied in one go.
+ * =====================================================================================
+ */
+void Line_AddChars(const uint8_t* data, size_t len);
+
+/* 
+ * ===  FUNCTION  ======================================================================
+ *         Name:  Line_DmaRx
+ *  Description:  Process the characters written by a circular DMA since the last call.
+                  To be called from the half-transfer, transfer-complete and idle line
+                  callbacks, with pos the current DMA write position in the buffer
+                  (buffer size minus the remaining transfer count). Data that wraps
+                  around the end of the buffer is handled. Line_Init resets the read
+                  position to the start of the buffer.
+ * =====================================================================================
+ */
+void Line_DmaRx(const uint8_t* dmabuf, size_t bufsz, size_t pos);
+
 /* 
  * ===  FUNCTION  ======================================================================
  *         Name:  Line_BuffIsEmpty
@@ -59,7 +183,7 @@ uint8_t Line_BuffIsEmpty (void);
  *  Description:  Get the current number of bytes in buffer.
  * =====================================================================================
  */
-uint8_t Line_GetCnt (void);
+uint16_t Line_GetCnt (void);
 
 /* 
  * ===  FUNCTION  ======================================================================
@@ -79,14 +203,61 @@ uint8_t Line_BuffIsFull (void);
 void Line_GetBuff (uint8_t* buff);
 
 
+/* 
+ * ===  FUNCTION  ======================================================================
+ *         Name:  Line_PopBuff
+ *  Description:  Copy the oldest complete line and release its slot so that it can
+                  receive a new line. Does nothing if no line is complete. This function
+                  assumes there is enough space in the target buffer to copy all data.
+ * =====================================================================================
+ */
+void Line_PopBuff (uint8_t* buff);
+
+/* 
+ * ===  FUNCTION  ======================================================================
+ *         Name:  Line_AcquireBuff
+ *  Description:  Take ownership of the oldest complete line so that it can be used in
+                  place, without copying it. Returns NULL if no line is complete. The
+                  line stays valid and reception continues on the other slots until
+                  Line_ReleaseBuff is called.
+ * =====================================================================================
+ */
+const uint8_t* Line_AcquireBuff (void);
+
+/* 
+ * ===  FUNCTION  ======================================================================
+ *         Name:  Line_ReleaseBuff
+ *  Description:  Give the line taken with Line_AcquireBuff back to the receiver.
+ * =====================================================================================
+ */
+void Line_ReleaseBuff (void);
+
 /* 
  * ===  FUNCTION  ======================================================================
  *         Name:  Line_FlushBuff
- *  Description:  Set contents of buffer to zero and reset counter.
+ *  Description:  Discard the complete lines waiting in the queue. Called from the
+                  main loop, under the same rules as Line_ReleaseBuff; the line being
+                  received is left to the receiver, so reception may go on.
  * =====================================================================================
  */
 void Line_FlushBuff (void);
 
+/* 
+ * ===  FUNCTION  ======================================================================
+ *         Name:  Line_GetQueueCnt
+ *  Description:  Get the number of complete lines waiting to be processed.
+ * =====================================================================================
+ */
+uint8_t Line_GetQueueCnt (void);
+
+/* 
+ * ===  FUNCTION  ======================================================================
+ *         Name:  Line_GetDropCnt
+ *  Description:  Get the number of lines dropped because the queue was full.
+ * =====================================================================================
+ */
+uint16_t Line_GetDropCnt (void);
+
 /* 
  * ===  FUNCTION  ======================================================================
  *         Name:  Line_IsCmplt
@@ -102,3 +273,58 @@ uint8_t Line_IsCmplt (void);
  * =====================================================================================
  */
 uint8_t Line_BuffIsOvrFlwn ( void );
+
+#if UCMD_LATENCY
+/* 
+ * ===  FUNCTION  ======================================================================
+ *         Name:  Line_SetClock
+ *  Description:  Set the clock that stamps completed lines, shared by all instances.
+                  uCmd_SetClock sets it too, so that both ends use the same ticks.
+                  Without one, lines are stamped 0.
+ * =====================================================================================
+ */
+void Line_SetClock (Line_Clock clock);
+
+/* 
+ * ===  FUNCTION  ======================================================================
+ *         Name:  Line_GetStamp
+ *  Description:  Get the completion time of the oldest complete line. Returns 0, and
+                  leaves stamp untouched, if no line is complete.
+ * =====================================================================================
+ */
+uint8_t Line_GetStamp (uint32_t* stamp);
+#endif
+
+/* 
+ * ===  FUNCTIONS  =====================================================================
+ *         Name:  LineCtx_*
+ *  Description:  Each Line_ function above works on a default instance. The LineCtx_
+                  functions below do the same on the instance given as first argument,
+                  so that several channels can be received independently. Different
+                  instances share no state.
+ * =====================================================================================
+ */
+LineCtx_s* Line_GetCtx (void);
+void LineCtx_Init (LineCtx_s* ctx);
+void LineCtx_SetCmpltCallback (LineCtx_s* ctx, Line_Callback callback, void* arg);
+void LineCtx_SetOvrFlwCallback (LineCtx_s* ctx, Line_Callback callback, void* arg);
+void LineCtx_AddChar (LineCtx_s* ctx, char ch);
+void LineCtx_AddChars (LineCtx_s* ctx, const uint8_t* data, size_t len);
+void LineCtx_DmaRx (LineCtx_s* ctx, const uint8_t* dmabuf, size_t bufsz, size_t pos);
+uint8_t LineCtx_BuffIsEmpty (LineCtx_s* ctx);
+uint16_t LineCtx_GetCnt (LineCtx_s* ctx);
+uint8_t LineCtx_BuffIsFull (LineCtx_s* ctx);
+void LineCtx_GetBuff (LineCtx_s* ctx, uint8_t* buff);
+void LineCtx_PopBuff (LineCtx_s* ctx, uint8_t* buff);
+const uint8_t* LineCtx_AcquireBuff (LineCtx_s* ctx);
+void LineCtx_ReleaseBuff (LineCtx_s* ctx);
+void LineCtx_FlushBuff (LineCtx_s* ctx);
+uint8_t LineCtx_GetQueueCnt (LineCtx_s* ctx);
+uint16_t LineCtx_GetDropCnt (LineCtx_s* ctx);
+uint8_t LineCtx_IsCmplt (LineCtx_s* ctx);
+uint8_t LineCtx_BuffIsOvrFlwn (LineCtx_s* ctx);
+#if UCMD_LATENCY
+uint8_t LineCtx_GetStamp (LineCtx_s* ctx, uint32_t* stamp);
+#endif
+
+#endif
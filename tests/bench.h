@@ -0,0 +1,33 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <time.h>
+
+/* Host side benchmarks. Timing is done with the monotonic clock, results
+ * are printed as nanoseconds per operation. */
+
+static inline uint64_t bench_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* Keeps the optimizer from discarding results that are otherwise unused. */
+extern volatile uintptr_t bench_sink;
+
+void bench_lookup(void);
+void bench_nested(void);
+void bench_parse(void);
+void bench_loop(void);
+void bench_latency(void);
+void bench_stream(void);
+void bench_frame(void);
+void bench_stages(void);
+void bench_strto(void);
+void bench_tx(void);
+void bench_fmt(void);
+void bench_stats(void);
+void bench_trace(void);
+
+#endif
@@ -0,0 +1,69 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "bench.h"
+#include "fmt.h"
+
+#define BENCH_FMT_ITER (1000000)
+#define BENCH_FMT_VALS (64)
+#define BENCH_FMT_ROUNDS (5) // Best round is kept.
+
+/* Best ns per call of _call over all values of the current row. */
+#define BENCH_FMT_BEST(_best, _call) do { \
+    size_t _round, _i; \
+    uint64_t _start; \
+    double _ns; \
+    (_best) = 1e30; \
+    for(_round = 0; _round < BENCH_FMT_ROUNDS; _round++) { \
+      _start = bench_now_ns(); \
+      for(_i = 0; _i < BENCH_FMT_ITER; _i++) { \
+        uint32_t val = vals[_i % BENCH_FMT_VALS]; \
+        (void)(_call); \
+        bench_sink += (uintptr_t)buf[0]; \
+      } \
+      _ns = (double)(bench_now_ns() - _start) / BENCH_FMT_ITER; \
+      (_best) = (_ns < (_best)) ? _ns : (_best); \
+    } \
+  } while(0)
+
+void bench_fmt(void) {
+  static const size_t digits_a[] = {1, 3, 5, 8, 10};
+  static uint32_t vals[BENCH_FMT_VALS];
+  char buf[FMT_FIX_MAX_LEN + 1];
+  size_t len = 0;
+  double fmt_ns, libc_ns;
+  size_t d, i, j;
+
+  printf("\n--- Decimal formatting (ns/call) ---\n");
+  printf("%6s %10s %10s\n", "digits", "u32tostr", "snprintf");
+  srand(1);
+  for(d = 0; d < sizeof(digits_a) / sizeof(digits_a[0]); d++) {
+    for(i = 0; i < BENCH_FMT_VALS; i++) {
+      /* Leading digit below 4 keeps 10 digit values within uint32_t. */
+      vals[i] = 1u + (uint32_t)(rand() % 3);
+      for(j = 1; j < digits_a[d]; j++) {
+        vals[i] = (vals[i] * 10u) + (uint32_t)(rand() % 10);
+      }
+    }
+    BENCH_FMT_BEST(fmt_ns, u32tostr(buf, sizeof(buf), val, &len));
+    BENCH_FMT_BEST(libc_ns, snprintf(buf, sizeof(buf), "%" PRIu32, val));
+    printf("%6zu %10.2f %10.2f\n", digits_a[d], fmt_ns, libc_ns);
+  }
+
+  /* Full range values, as telemetry registers and scaled readings are. */
+  for(i = 0; i < BENCH_FMT_VALS; i++) {
+    vals[i] = ((uint32_t)rand() << 17) ^ (uint32_t)rand();
+  }
+  printf("\n--- Other formats (ns/call) ---\n");
+  printf("%10s %10s %10s\n", "format", "fmt", "snprintf");
+  BENCH_FMT_BEST(fmt_ns, i32tostr(buf, sizeof(buf), (int32_t)val, &len));
+  BENCH_FMT_BEST(libc_ns, snprintf(buf, sizeof(buf), "%" PRId32, (int32_t)val));
+  printf("%10s %10.2f %10.2f\n", "i32", fmt_ns, libc_ns);
+  BENCH_FMT_BEST(fmt_ns, u32tohex(buf, sizeof(buf), val, 8, &len));
+  BENCH_FMT_BEST(libc_ns, snprintf(buf, sizeof(buf), "%08" PRIX32, val));
+  printf("%10s %10.2f %10.2f\n", "hex8", fmt_ns, libc_ns);
+  BENCH_FMT_BEST(fmt_ns, fixtostr(buf, sizeof(buf), (int32_t)val, 3, &len));
+  BENCH_FMT_BEST(libc_ns, snprintf(buf, sizeof(buf), "%.3f", (double)(int32_t)val / 1000.0));
+  printf("%10s %10.2f %10.2f\n", "fix3", fmt_ns, libc_ns);
+  bench_sink += len;
+}
@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "ucmd.h"
+
+#define BENCH_LOOKUP_ITER (200000)
+
+extern ErrCode_e _get_cmd(const char* cmdstr, size_t len, const uCmdTable_s * cmd_table, size_t* idx);
+extern ErrCode_e _build_hash(const uCmdTable_s* table, uCmdHash_s* hash);
+
+static ErrCode_e bench_handle(Arg_s* args, void* usrargs) {
+  (void)args;
+  (void)usrargs;
+  return E_OK;
+}
+
+static double bench_lookup_ns(const uCmdTable_s* table, char (*names)[UCMD_NAME_MAX_SIZE], size_t n) {
+  size_t idx = 0;
+  uint64_t start;
+  size_t i;
+  start = bench_now_ns();
+  for(i = 0; i < BENCH_LOOKUP_ITER; i++) {
+    _get_cmd(names[i % n], strlen(names[i % n]), table, &idx);
+    bench_sink += idx;
+  }
+  return (double)(bench_now_ns() - start) / BENCH_LOOKUP_ITER;
+}
+
+void bench_lookup(void) {
+  static uCmdHash_s hash;
+  static char hits[UCMD_TABLE_MAX_SIZE][UCMD_NAME_MAX_SIZE];
+  static char misses[UCMD_TABLE_MAX_SIZE][UCMD_NAME_MAX_SIZE];
+  uCmdInfo_s* info_a = calloc(UCMD_TABLE_MAX_SIZE, sizeof(uCmdInfo_s));
+  uCmdTable_s table = { .info_a = NULL, .size = 0 };
+  size_t n;
+  size_t i;
+
+  printf("\n--- Command lookup (ns/lookup) ---\n");
+  printf("%6s %12s %12s %12s %12s\n", "size", "linear hit", "linear miss", "hash hit", "hash miss");
+  for(i = 0; i < UCMD_TABLE_MAX_SIZE; i++) {
+    /* Entries live in heap memory, so the const qualified members can be
+       filled in place. */
+    snprintf((char*)info_a[i].cmdname, UCMD_NAME_MAX_SIZE, "motor_cmd_%zu", i);
+    memcpy((void*)&info_a[i].handle, &(CallbackPtr_t){bench_handle}, sizeof(CallbackPtr_t));
+    snprintf(hits[i], UCMD_NAME_MAX_SIZE, "motor_cmd_%zu", i);
+    snprintf(misses[i], UCMD_NAME_MAX_SIZE, "motor_cmx_%zu", i);
+  }
+
+  for(n = 1; n <= UCMD_TABLE_MAX_SIZE; n *= 2) {
+    table.info_a = info_a;
+    table.size = n;
+    table.hash = NULL;
+    printf("%6zu %12.1f %12.1f", n, bench_lookup_ns(&table, hits, n), bench_lookup_ns(&table, misses, n));
+    if(_build_hash(&table, &hash) == E_OK) {
+      table.hash = &hash;
+      printf(" %12.1f %12.1f\n", bench_lookup_ns(&table, hits, n), bench_lookup_ns(&table, misses, n));
+    } else {
+      printf(" %12s %12s\n", "-", "-");
+    }
+  }
+  free(info_a);
+}
+
+#define BENCH_NESTED_GROUPS (16)
+#define BENCH_NESTED_CMDS (16)
+
+/* The same commands as one flat table of "motor3_pwm_9" names and as a
+   "motor 3 pwm_9" hierarchy, where each level is a table of its own. */
+void bench_nested(void) {
+  static char flat_lines[BENCH_NESTED_GROUPS * BENCH_NESTED_CMDS][UCMD_RAW_STR_MAX_SIZE];
+  static char nested_lines[BENCH_NESTED_GROUPS * BENCH_NESTED_CMDS][UCMD_RAW_STR_MAX_SIZE];
+  size_t cnt = BENCH_NESTED_GROUPS * BENCH_NESTED_CMDS;
+  uCmdInfo_s* flat_a = calloc(cnt, sizeof(uCmdInfo_s));
+  uCmdInfo_s* group_a = calloc(cnt, sizeof(uCmdInfo_s));
+  uCmdInfo_s top_a[1] = {{"motor", uCmd_SubTable, UCMD_ARG_NONE, NULL}};
+  uCmdInfo_s* motor_a = calloc(BENCH_NESTED_GROUPS, sizeof(uCmdInfo_s));
+  uCmdCtx_s* ctx_a = calloc(BENCH_NESTED_GROUPS + 3, sizeof(uCmdCtx_s));
+  uCmdCtx_s* flat = &ctx_a[BENCH_NESTED_GROUPS];
+  uCmdCtx_s* top = &ctx_a[BENCH_NESTED_GROUPS + 1];
+  uCmdCtx_s* motor = &ctx_a[BENCH_NESTED_GROUPS + 2];
+  double flat_ns, nested_ns;
+  uint64_t start;
+  size_t g, c, i;
+
+  for(g = 0; g < BENCH_NESTED_GROUPS; g++) {
+    snprintf((char*)motor_a[g].cmdname, UCMD_NAME_MAX_SIZE, "%zu", g);
+    memcpy((void*)&motor_a[g].handle, &(CallbackPtr_t){uCmd_SubTable}, sizeof(CallbackPtr_t));
+    motor_a[g].userarg = &ctx_a[g];
+    for(c = 0; c < BENCH_NESTED_CMDS; c++) {
+      i = g * BENCH_NESTED_CMDS + c;
+      snprintf((char*)flat_a[i].cmdname, UCMD_NAME_MAX_SIZE, "motor%zu_pwm_%zu", g, c);
+      snprintf((char*)group_a[i].cmdname, UCMD_NAME_MAX_SIZE, "pwm_%zu", c);
+      memcpy((void*)&flat_a[i].handle, &(CallbackPtr_t){bench_handle}, sizeof(CallbackPtr_t));
+      memcpy((void*)&group_a[i].handle, &(CallbackPtr_t){bench_handle}, sizeof(CallbackPtr_t));
+      snprintf(flat_lines[i], UCMD_RAW_STR_MAX_SIZE, "motor%zu_pwm_%zu", g, c);
+      snprintf(nested_lines[i], UCMD_RAW_STR_MAX_SIZE, "motor %zu pwm_%zu", g, c);
+    }
+    uCmdCtx_InitTable(&ctx_a[g], &group_a[g * BENCH_NESTED_CMDS], BENCH_NESTED_CMDS);
+  }
+  top_a[0].userarg = motor;
+  uCmdCtx_InitTable(motor, motor_a, BENCH_NESTED_GROUPS);
+  uCmdCtx_InitTable(top, top_a, 1);
+  uCmdCtx_InitTable(flat, flat_a, cnt);
+
+  start = bench_now_ns();
+  for(i = 0; i < BENCH_LOOKUP_ITER; i++) {
+    bench_sink += (uintptr_t)uCmdCtx_Run(flat, flat_lines[i % cnt]);
+  }
+  flat_ns = (double)(bench_now_ns() - start) / BENCH_LOOKUP_ITER;
+  start = bench_now_ns();
+  for(i = 0; i < BENCH_LOOKUP_ITER; i++) {
+    bench_sink += (uintptr_t)uCmdCtx_Run(top, nested_lines[i % cnt]);
+  }
+  nested_ns = (double)(bench_now_ns() - start) / BENCH_LOOKUP_ITER;
+
+  printf("\n--- Flat against nested tables, %zu commands (ns/cmd) ---\n", cnt);
+  printf("%12s %12s\n", "flat", "nested");
+  printf("%12.1f %12.1f\n", flat_ns, nested_ns);
+  free(ctx_a);
+  free(motor_a);
+  free(group_a);
+  free(flat_a);
+}
@@ -0,0 +1,207 @@
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+#include "line.h"
+#include "ucmd.h"
+
+#define BENCH_LOOP_ITER (100000)
+#define BENCH_LOOP_CALLBACK_NS (2000)
+
+/* Stands in for user code that takes a couple of microseconds. */
+static ErrCode_e bench_busy_handle(Arg_s* args, void* usrargs) {
+  uint64_t end = bench_now_ns() + BENCH_LOOP_CALLBACK_NS;
+  (void)args;
+  (void)usrargs;
+  while(bench_now_ns() < end) {}
+  return E_OK;
+}
+
+static const uCmdInfo_s _bench_loop_table[] = {
+  {"pwm", bench_busy_handle, {UCMD_ARG_DESC(E_ARG_U16, 'f'), UCMD_ARG_DESC(E_ARG_U8, 'd')}, UCMD_ARG_USER_NONE},
+};
+
+static ErrCode_e bench_nop_handle(Arg_s* args, void* usrargs) {
+  bench_sink += args[0].data[0] + (uintptr_t)usrargs;
+  return E_OK;
+}
+
+static const uCmdInfo_s _bench_stream_table[] = {
+  {"led", bench_nop_handle, {UCMD_ARG_DESC(E_ARG_U8, 'n')}, UCMD_ARG_USER_NONE},
+  {"pwm", bench_nop_handle, {UCMD_ARG_DESC(E_ARG_U16, 'f'), UCMD_ARG_DESC(E_ARG_U8, 'd')}, UCMD_ARG_USER_NONE},
+  {"pwm_stop", bench_nop_handle, UCMD_ARG_NONE, UCMD_ARG_USER_NONE},
+  {"reset", bench_nop_handle, UCMD_ARG_NONE, UCMD_ARG_USER_NONE},
+  {"motor", bench_nop_handle, {UCMD_ARG_DESC(E_ARG_U16, 'f'), UCMD_ARG_DESC(E_ARG_I16, 'p'), UCMD_ARG_DESC(E_ARG_I32, 's'), UCMD_ARG_DESC(E_ARG_U8, 'd')},
+   UCMD_ARG_USER_NONE},
+};
+
+static void bench_loop_feed(const char* str) {
+  while(*str) {
+    Line_AddChar(*str++);
+  }
+}
+
+/* uCmd_Loop step by step, timing the part that needs the lock on targets
+ * without lock-free atomics (buffer ownership swap) against the part that
+ * used to run under it as well (copy, parse and callback). */
+void bench_loop(void) {
+  char rawcmd[LINE_BUFF_SIZE];
+  const char* line;
+  uint64_t t0, t1, t2, t3;
+  uint64_t swap_sum = 0, swap_max = 0;
+  uint64_t full_sum = 0, full_max = 0;
+  size_t i;
+
+  uCmd_InitTable(_bench_loop_table, UCMD_GET_TABLE_SIZE(_bench_loop_table));
+  Line_Init();
+  for(i = 0; i < BENCH_LOOP_ITER; i++) {
+    bench_loop_feed("pwm f2000 d50\n");
+    t0 = bench_now_ns();
+    line = (const char*)Line_AcquireBuff();
+    t1 = bench_now_ns();
+    /* The copy the loop used to make is kept for comparison. */
+    memcpy(rawcmd, line, LINE_BUFF_SIZE);
+    bench_sink += uCmd_Run(rawcmd);
+    t2 = bench_now_ns();
+    Line_ReleaseBuff();
+    t3 = bench_now_ns();
+    swap_sum += (t1 - t0) + (t3 - t2);
+    swap_max = ((t1 - t0) + (t3 - t2) > swap_max) ? (t1 - t0) + (t3 - t2) : swap_max;
+    full_sum += t3 - t0;
+    full_max = (t3 - t0 > full_max) ? t3 - t0 : full_max;
+  }
+  printf("\n--- uCmd_Loop time under lock (ns), %d ns callback ---\n", BENCH_LOOP_CALLBACK_NS);
+  printf("%-28s %10s %10s\n", "", "mean", "max");
+  printf("%-28s %10.1f %10llu\n", "copy + parse + callback", (double)full_sum / BENCH_LOOP_ITER, (unsigned long long)full_max);
+  printf("%-28s %10.1f %10llu\n", "buffer swap", (double)swap_sum / BENCH_LOOP_ITER, (unsigned long long)swap_max);
+}
+
+/* Line plus uCmd_Loop against the character-level parser. The receiving side
+ * is timed per character, the main loop from end of line to callback return. */
+void bench_stream(void) {
+  static const char cmd[] = "pwm f2000 d50\n";
+  const size_t len = sizeof(cmd) - 1;
+  uint64_t t0, t1, t2;
+  uint64_t rx_sum = 0, loop_sum = 0, loop_max = 0;
+  size_t i, j;
+
+  printf("\n--- Line + uCmd_Loop vs stream parser (ns) ---\n");
+  printf("%-10s %12s %12s %12s\n", "", "rx/char", "loop mean", "loop max");
+  uCmd_InitTable(_bench_stream_table, sizeof(_bench_stream_table) / sizeof(_bench_stream_table[0]));
+  Line_Init();
+  for(i = 0; i < BENCH_LOOP_ITER; i++) {
+    t0 = bench_now_ns();
+    for(j = 0; j < len; j++) {
+      Line_AddChar(cmd[j]);
+    }
+    t1 = bench_now_ns();
+    bench_sink += uCmd_Loop();
+    t2 = bench_now_ns();
+    rx_sum += t1 - t0;
+    loop_sum += t2 - t1;
+    loop_max = (t2 - t1 > loop_max) ? t2 - t1 : loop_max;
+  }
+  printf("%-10s %12.1f %12.1f %12llu\n", "line", (double)rx_sum / (BENCH_LOOP_ITER * len),
+         (double)loop_sum / BENCH_LOOP_ITER, (unsigned long long)loop_max);
+
+  rx_sum = loop_sum = loop_max = 0;
+  for(i = 0; i < BENCH_LOOP_ITER; i++) {
+    t0 = bench_now_ns();
+    for(j = 0; j < len; j++) {
+      uCmd_StreamChar(cmd[j]);
+    }
+    t1 = bench_now_ns();
+    bench_sink += uCmd_StreamLoop();
+    t2 = bench_now_ns();
+    rx_sum += t1 - t0;
+    loop_sum += t2 - t1;
+    loop_max = (t2 - t1 > loop_max) ? t2 - t1 : loop_max;
+  }
+  printf("%-10s %12.1f %12.1f %12llu\n", "stream", (double)rx_sum / (BENCH_LOOP_ITER * len),
+         (double)loop_sum / BENCH_LOOP_ITER, (unsigned long long)loop_max);
+}
+
+#if UCMD_LATENCY
+/* Host stand-in for a cycle counter. */
+static uint32_t _bench_latency_clock(void) {
+  return (uint32_t)bench_now_ns();
+}
+
+/* Bursts of lines completed back to back, then run by uCmd_Loop with the
+ * busy callback: each line waits for the callbacks of the lines before it. */
+void bench_latency(void) {
+  uCmdLatency_s lat;
+  size_t burst, i, j;
+
+  printf("\n--- Line completion to callback start (ns), %d ns callback ---\n", BENCH_LOOP_CALLBACK_NS);
+  printf("%-6s %10s %10s %10s\n", "burst", "min", "mean", "max");
+  uCmd_InitTable(_bench_loop_table, UCMD_GET_TABLE_SIZE(_bench_loop_table));
+  Line_Init();
+  uCmd_SetClock(_bench_latency_clock);
+  for(burst = 1; burst <= LINE_QUEUE_DEPTH; burst *= 2) {
+    uCmd_ResetLatency();
+    for(i = 0; i < BENCH_LOOP_ITER / 10; i++) {
+      for(j = 0; j < burst; j++) {
+        bench_loop_feed("pwm f2000 d50\n");
+      }
+      while(Line_IsCmplt()) {
+        bench_sink += uCmd_Loop();
+      }
+    }
+    uCmd_GetLatency(&lat);
+    printf("%-6zu %10lu %10lu %10lu\n", burst, (unsigned long)lat.min, (unsigned long)lat.mean,
+           (unsigned long)lat.max);
+  }
+  uCmd_SetClock(NULL);
+}
+#endif
+
+#if UCMD_FRAME
+#define BENCH_FRAME_BAUD (115200)
+#define BENCH_FRAME_BITS (10) // 8N1: start, 8 data bits, stop.
+
+/* Same commands as text through the stream parser and as binary frames. The
+ * link rate is the one a UART at BENCH_FRAME_BAUD allows for their size. */
+void bench_frame(void) {
+  static const char* const text_a[] = {"pwm f2000 d50\n", "motor f20000 p-1200 s-300000 d99\n"};
+  static const uint8_t pwm_args[] = {0xD0, 0x07, 50};
+  static const uint8_t motor_args[] = {0x20, 0x4E, 0x50, 0xFB, 0x20, 0x6C, 0xFB, 0xFF, 99};
+  static const uint8_t* const args_a[] = {pwm_args, motor_args};
+  static const size_t args_sz_a[] = {sizeof(pwm_args), sizeof(motor_args)};
+  static const uint16_t cmd_a[] = {1, 4};
+  uint8_t frame[UCMD_FRAME_MAX_SIZE];
+  size_t frame_sz = 0;
+  size_t text_sz;
+  double text_ns, frame_ns;
+  uint64_t start;
+  size_t c, i, j;
+
+  printf("\n--- Text vs binary frames, %d baud ---\n", BENCH_FRAME_BAUD);
+  printf("%-6s %8s %8s %10s %10s %11s %11s\n", "cmd", "text B", "frame B", "text ns", "frame ns",
+         "text cmd/s", "frame cmd/s");
+  uCmd_InitTable(_bench_stream_table, sizeof(_bench_stream_table) / sizeof(_bench_stream_table[0]));
+  for(c = 0; c < sizeof(cmd_a) / sizeof(cmd_a[0]); c++) {
+    text_sz = strlen(text_a[c]);
+    uCmdFrame_Encode(frame, sizeof(frame), cmd_a[c], args_a[c], args_sz_a[c], &frame_sz);
+    start = bench_now_ns();
+    for(i = 0; i < BENCH_LOOP_ITER; i++) {
+      for(j = 0; j < text_sz; j++) {
+        uCmd_StreamChar(text_a[c][j]);
+      }
+      bench_sink += uCmd_StreamLoop();
+    }
+    text_ns = (double)(bench_now_ns() - start) / BENCH_LOOP_ITER;
+    start = bench_now_ns();
+    for(i = 0; i < BENCH_LOOP_ITER; i++) {
+      for(j = 0; j < frame_sz; j++) {
+        uCmd_FrameByte(frame[j]);
+      }
+      bench_sink += uCmd_FrameLoop();
+    }
+    frame_ns = (double)(bench_now_ns() - start) / BENCH_LOOP_ITER;
+    printf("%-6.*s %8zu %8zu %10.1f %10.1f %11.0f %11.0f\n", (int)strcspn(text_a[c], " "), text_a[c],
+           text_sz, frame_sz, text_ns, frame_ns,
+           (double)BENCH_FRAME_BAUD / BENCH_FRAME_BITS / text_sz,
+           (double)BENCH_FRAME_BAUD / BENCH_FRAME_BITS / frame_sz);
+  }
+}
+#endif
@@ -0,0 +1,30 @@
+#include <stdio.h>
+#include "bench.h"
+#include "ucmd_config.h"
+
+volatile uintptr_t bench_sink;
+
+int main(void) {
+  bench_lookup();
+  bench_nested();
+  bench_parse();
+  bench_loop();
+#if UCMD_LATENCY
+  bench_latency();
+#endif
+  bench_stream();
+#if UCMD_FRAME
+  bench_frame();
+#endif
+  bench_stages();
+#if UCMD_STATS
+  bench_stats();
+#endif
+#if UCMD_TRACE
+  bench_trace();
+#endif
+  bench_strto();
+  bench_fmt();
+  bench_tx();
+  return 0;
+}
@@ -0,0 +1,58 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "ucmd.h"
+
+#define BENCH_PARSE_ITER (100000)
+
+/* The benchmark links with --wrap=strcmp,--wrap=strncmp so that string
+ * compares done by the parser can be counted. */
+extern int __real_strcmp(const char* s1, const char* s2);
+extern int __real_strncmp(const char* s1, const char* s2, size_t n);
+static size_t _strcmp_cnt = 0;
+
+int __wrap_strcmp(const char* s1, const char* s2) {
+  _strcmp_cnt++;
+  return __real_strcmp(s1, s2);
+}
+
+int __wrap_strncmp(const char* s1, const char* s2, size_t n) {
+  _strcmp_cnt++;
+  return __real_strncmp(s1, s2, n);
+}
+
+static ErrCode_e bench_handle(Arg_s* args, void* usrargs) {
+  (void)args;
+  (void)usrargs;
+  return E_OK;
+}
+
+void bench_parse(void) {
+  static char cmds[UCMD_TABLE_MAX_SIZE][UCMD_RAW_STR_MAX_SIZE];
+  uCmdInfo_s* info_a = calloc(UCMD_TABLE_MAX_SIZE, sizeof(uCmdInfo_s));
+  uint64_t start;
+  double ns;
+  size_t n;
+  size_t i;
+
+  printf("\n--- uCmd_Run dispatch ---\n");
+  printf("%6s %14s %12s\n", "size", "strcmp/cmd", "ns/cmd");
+  for(i = 0; i < UCMD_TABLE_MAX_SIZE; i++) {
+    snprintf((char*)info_a[i].cmdname, UCMD_NAME_MAX_SIZE, "motor_cmd_%zu", i);
+    memcpy((void*)&info_a[i].handle, &(CallbackPtr_t){bench_handle}, sizeof(CallbackPtr_t));
+    snprintf(cmds[i], UCMD_RAW_STR_MAX_SIZE, "motor_cmd_%zu", i);
+  }
+
+  for(n = 1; n <= UCMD_TABLE_MAX_SIZE; n *= 4) {
+    uCmd_InitTable(info_a, n);
+    _strcmp_cnt = 0;
+    start = bench_now_ns();
+    for(i = 0; i < BENCH_PARSE_ITER; i++) {
+      bench_sink += (uintptr_t)uCmd_Run(cmds[i % n]);
+    }
+    ns = (double)(bench_now_ns() - start) / BENCH_PARSE_ITER;
+    printf("%6zu %14.2f %12.1f\n", n, (double)_strcmp_cnt / BENCH_PARSE_ITER, ns);
+  }
+  free(info_a);
+}
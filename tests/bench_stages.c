@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "ucmd.h"
+
+#define BENCH_STAGES_ITER (20000)
+#define BENCH_STAGES_ROUNDS (5) // Best round is kept, others absorb scheduling noise.
+#define BENCH_STAGES_ARGS (UCMD_ARG_MAX_SIZE)
+
+/* Parser stages, visible as the benchmark is built with UNIT_TEST. */
+extern ErrCode_e _get_param(const char* rawstr, size_t* len, uint8_t* done);
+extern ErrCode_e _get_arg(const char* rawstr, size_t len, const uCmdTable_s* table, size_t idx, Arg_s* arg);
+extern ErrCode_e _get_cmd(const char* cmdstr, size_t len, const uCmdTable_s* cmd_table, size_t* idx);
+
+/* Token spans of one command line, found once so each stage can be timed alone. */
+typedef struct BenchLine {
+  char str[UCMD_RAW_STR_MAX_SIZE];
+  const char* tok[BENCH_STAGES_ARGS + 1];
+  size_t len[BENCH_STAGES_ARGS + 1];
+  size_t argcnt;
+} BenchLine_s;
+
+static const ArgDesc_s _argdesc_a[BENCH_STAGES_ARGS] = {
+  UCMD_ARG_DESC(E_ARG_U8, 'a'), UCMD_ARG_DESC(E_ARG_U16, 'b'), UCMD_ARG_DESC(E_ARG_U32, 'c'), UCMD_ARG_DESC(E_ARG_I32, 'd'),
+};
+/* Same arguments, bound to a struct instead of the Arg_s array. */
+typedef struct BenchArgs {
+  uint8_t a;
+  uint16_t b;
+  uint32_t c;
+  int32_t d;
+} BenchArgs_s;
+static BenchArgs_s _bound_s;
+static const ArgDesc_s _argbind_a[BENCH_STAGES_ARGS] = {
+  UCMD_ARG_BIND(E_ARG_U8, 'a', BenchArgs_s, a), UCMD_ARG_BIND(E_ARG_U16, 'b', BenchArgs_s, b),
+  UCMD_ARG_BIND(E_ARG_U32, 'c', BenchArgs_s, c), UCMD_ARG_BIND(E_ARG_I32, 'd', BenchArgs_s, d),
+};
+static const char* const _argstr_a[BENCH_STAGES_ARGS] = {
+  "a12", "b3456", "c789012", "d-42",
+};
+
+/* Shortest of the rounds, per command. */
+#define BENCH_BEST_OF(_best, _body) do { \
+    size_t _round; \
+    (_best) = 1e30; \
+    for(_round = 0; _round < BENCH_STAGES_ROUNDS; _round++) { \
+      uint64_t _start = bench_now_ns(); \
+      _body \
+      double _ns = (double)(bench_now_ns() - _start) / BENCH_STAGES_ITER; \
+      (_best) = (_ns < (_best)) ? _ns : (_best); \
+    } \
+  } while(0)
+
+static ErrCode_e bench_handle(Arg_s* args, void* usrargs) {
+  bench_sink += (uintptr_t)args[0].data[0] + (uintptr_t)usrargs;
+  return E_OK;
+}
+
+static void _line_build(BenchLine_s* line, const char* name, size_t idx, size_t argcnt) {
+  size_t ofs = (size_t)snprintf(line->str, sizeof(line->str), "%s_%zu", name, idx);
+  size_t i;
+  uint8_t done = 0;
+  const char* p = line->str;
+  for(i = 0; i < argcnt; i++) {
+    ofs += (size_t)snprintf(&line->str[ofs], sizeof(line->str) - ofs, " %s", _argstr_a[i]);
+  }
+  line->argcnt = argcnt;
+  for(i = 0; i <= argcnt; i++) {
+    (void)_get_param(p, &line->len[i], &done);
+    line->tok[i] = p;
+    p += line->len[i] + 1;
+  }
+}
+
+static double _bench_tokenize(const BenchLine_s* lines, size_t n) {
+  double best;
+  size_t i;
+  BENCH_BEST_OF(best,
+    for(i = 0; i < BENCH_STAGES_ITER; i++) {
+      const char* p = lines[i % n].str;
+      size_t len = 0;
+      uint8_t done = 0;
+      while(!done && (_get_param(p, &len, &done) == E_OK)) {
+        p += len + 1;
+      }
+      bench_sink += len;
+    }
+  );
+  return best;
+}
+
+static double _bench_lookup(const BenchLine_s* lines, size_t n, const uCmdTable_s* table) {
+  size_t idx = 0;
+  double best;
+  size_t i;
+  BENCH_BEST_OF(best,
+    for(i = 0; i < BENCH_STAGES_ITER; i++) {
+      const BenchLine_s* line = &lines[i % n];
+      (void)_get_cmd(line->tok[0], line->len[0], table, &idx);
+      bench_sink += idx;
+    }
+  );
+  return best;
+}
+
+static double _bench_convert(const BenchLine_s* lines, size_t n, const uCmdTable_s* table) {
+  Arg_s args[UCMD_ARG_MAX_SIZE];
+  double best;
+  size_t i, j;
+  BENCH_BEST_OF(best,
+    for(i = 0; i < BENCH_STAGES_ITER; i++) {
+      const BenchLine_s* line = &lines[i % n];
+      for(j = 1; j <= line->argcnt; j++) {
+        (void)_get_arg(line->tok[j], line->len[j], table, 0, args);
+      }
+      bench_sink += args[0].data[0];
+    }
+  );
+  return best;
+}
+
+static double _bench_dispatch(const uCmdInfo_s* info_a, size_t n) {
+  Arg_s args[UCMD_ARG_MAX_SIZE] = {{0}};
+  double best;
+  size_t i;
+  BENCH_BEST_OF(best,
+    for(i = 0; i < BENCH_STAGES_ITER; i++) {
+      const uCmdInfo_s* info = &info_a[i % n];
+      bench_sink += (uintptr_t)info->handle(args, info->userarg);
+    }
+  );
+  return best;
+}
+
+static double _bench_run(const BenchLine_s* lines, size_t n, uCmdCtx_s* ctx) {
+  double best;
+  size_t i;
+  BENCH_BEST_OF(best,
+    for(i = 0; i < BENCH_STAGES_ITER; i++) {
+      bench_sink += (uintptr_t)uCmdCtx_Run(ctx, lines[i % n].str);
+    }
+  );
+  return best;
+}
+
+#if UCMD_PACKED
+#define BENCH_STAGES_KINDS (4)
+/* Packed copy of the first n commands of info_a, same names and arguments. */
+static void _pack_build(uCmdPacked_s* packed, char* names, uCmdPackedCmd_s* cmd_a,
+                        uCmdPackedArg_t* arg_a, const uCmdInfo_s* info_a, size_t n) {
+  size_t nameofs = 0;
+  size_t i, j;
+  for(i = 0; i < n; i++) {
+    nameofs += (size_t)sprintf(&names[nameofs], "%s", info_a[i].cmdname) + 1;
+    memcpy((void*)&cmd_a[i], &(uCmdPackedCmd_s){info_a[i].handle, info_a[i].userarg, BENCH_STAGES_ARGS},
+           sizeof(uCmdPackedCmd_s));
+    for(j = 0; j < BENCH_STAGES_ARGS; j++) {
+      arg_a[i * BENCH_STAGES_ARGS + j] = UCMD_PARG(_argdesc_a[j].argtype, _argdesc_a[j].argname);
+    }
+  }
+  packed->cmd_a = cmd_a;
+  packed->names = names;
+  packed->args = arg_a;
+  packed->size = (uint16_t)n;
+  packed->namesz = (uint16_t)nameofs;
+  packed->argsz = (uint16_t)(n * BENCH_STAGES_ARGS);
+}
+#else
+#define BENCH_STAGES_KINDS (3)
+#endif
+
+void bench_stages(void) {
+  static const char* const kind_a[] = {"hit", "miss", "bind", "pack"};
+  uCmdInfo_s* info_a = calloc(UCMD_TABLE_MAX_SIZE, sizeof(uCmdInfo_s));
+  uCmdInfo_s* bind_a = calloc(UCMD_TABLE_MAX_SIZE, sizeof(uCmdInfo_s));
+  BenchLine_s* hit_a = calloc(UCMD_TABLE_MAX_SIZE, sizeof(BenchLine_s));
+  BenchLine_s* miss_a = calloc(UCMD_TABLE_MAX_SIZE, sizeof(BenchLine_s));
+#if UCMD_PACKED
+  char* names = calloc(UCMD_TABLE_MAX_SIZE, UCMD_NAME_MAX_SIZE);
+  uCmdPackedCmd_s* pcmd_a = calloc(UCMD_TABLE_MAX_SIZE, sizeof(uCmdPackedCmd_s));
+  uCmdPackedArg_t* parg_a = calloc(UCMD_TABLE_MAX_SIZE, BENCH_STAGES_ARGS);
+  static uCmdPacked_s packed;
+#endif
+  static uCmdCtx_s ctx, bind_ctx, pack_ctx;
+  size_t n, argcnt, kind, i;
+
+  printf("\n--- uCmd_Run stages (ns/cmd) ---\n");
+  printf("%6s %4s %5s %9s %9s %9s %9s %9s %11s\n",
+         "size", "args", "kind", "tokenize", "lookup", "convert", "dispatch", "total", "cmd/s");
+  for(i = 0; i < UCMD_TABLE_MAX_SIZE; i++) {
+    snprintf((char*)info_a[i].cmdname, UCMD_NAME_MAX_SIZE, "motor_cmd_%zu", i);
+    memcpy((void*)&info_a[i].handle, &(CallbackPtr_t){bench_handle}, sizeof(CallbackPtr_t));
+    memcpy((void*)info_a[i].argdesc, _argdesc_a, sizeof(_argdesc_a));
+    memcpy((void*)&bind_a[i], &info_a[i], sizeof(uCmdInfo_s));
+    memcpy((void*)bind_a[i].argdesc, _argbind_a, sizeof(_argbind_a));
+    bind_a[i].userarg = &_bound_s;
+  }
+
+  for(n = 1; n <= UCMD_TABLE_MAX_SIZE; n *= 4) {
+    uCmdCtx_InitTable(&ctx, info_a, n);
+    uCmdCtx_InitTable(&bind_ctx, bind_a, n);
+#if UCMD_PACKED
+    _pack_build(&packed, names, pcmd_a, parg_a, info_a, n);
+    uCmdCtx_InitPacked(&pack_ctx, &packed);
+#endif
+    for(argcnt = 0; argcnt <= BENCH_STAGES_ARGS; argcnt++) {
+      for(i = 0; i < n; i++) {
+        _line_build(&hit_a[i], "motor_cmd", i, argcnt);
+        /* Same length as a hit, so only the lookup result differs. */
+        _line_build(&miss_a[i], "motor_xyz", i, argcnt);
+      }
+      for(kind = 0; kind < BENCH_STAGES_KINDS; kind++) {
+        uCmdCtx_s* kind_ctx = (kind == 2) ? &bind_ctx : (kind == 3) ? &pack_ctx : &ctx;
+        const BenchLine_s* lines = (kind == 1) ? miss_a : hit_a;
+        const uCmdInfo_s* table_a = (kind == 2) ? bind_a : info_a;
+        const uCmdTable_s* table = &kind_ctx->table;
+        double tok = _bench_tokenize(lines, n);
+        double lookup = _bench_lookup(lines, n, table);
+        /* A missed lookup stops the parser before conversion and dispatch. */
+        double conv = (kind == 1) ? 0.0 : _bench_convert(lines, n, table);
+        double disp = (kind == 1) ? 0.0 : _bench_dispatch(table_a, n);
+        double total = _bench_run(lines, n, kind_ctx);
+        printf("%6zu %4zu %5s %9.1f %9.1f %9.1f %9.1f %9.1f %11.0f\n",
+               n, argcnt, kind_a[kind], tok, lookup, conv, disp, total,
+               1e9 / total);
+      }
+    }
+  }
+#if UCMD_PACKED
+  free(parg_a);
+  free(pcmd_a);
+  free(names);
+#endif
+  free(miss_a);
+  free(hit_a);
+  free(bind_a);
+  free(info_a);
+}
@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include "bench.h"
+#include "ucmd.h"
+
+#define BENCH_STATS_ITER (200000)
+#define BENCH_STATS_ROUNDS (5) // Best round is kept.
+
+static ErrCode_e bench_stats_handle(Arg_s* args, void* usrargs) {
+  bench_sink += args[0].data[0] + (uintptr_t)usrargs;
+  return E_OK;
+}
+
+static const uCmdInfo_s _bench_stats_table[] = {
+  {"led", bench_stats_handle, {UCMD_ARG_DESC(E_ARG_U8, 'n')}, UCMD_ARG_USER_NONE},
+  {"pwm", bench_stats_handle, {UCMD_ARG_DESC(E_ARG_U16, 'f'), UCMD_ARG_DESC(E_ARG_U8, 'd')}, UCMD_ARG_USER_NONE},
+  {"reset", bench_stats_handle, UCMD_ARG_NONE, UCMD_ARG_USER_NONE},
+  UCMD_STATS_CMD(NULL),
+};
+
+/* Host stand-in for a cycle counter. */
+static uint32_t _bench_clock(void) {
+  return (uint32_t)bench_now_ns();
+}
+
+static double _bench_run(const char* line) {
+  double best = 1e30;
+  size_t round, i;
+  for(round = 0; round < BENCH_STATS_ROUNDS; round++) {
+    uint64_t start = bench_now_ns();
+    double ns;
+    for(i = 0; i < BENCH_STATS_ITER; i++) {
+      bench_sink += uCmd_Run(line);
+    }
+    ns = (double)(bench_now_ns() - start) / BENCH_STATS_ITER;
+    best = (ns < best) ? ns : best;
+  }
+  return best;
+}
+
+/* uCmd_Run with the counters detached, counting only, and timing with the
+ * monotonic clock. The clock reads are most of the timed overhead. */
+void bench_stats(void) {
+  static const char* const line_a[] = {"pwm f2000 d50", "reset", "nope"};
+  static uCmdStats_s stats;
+  double ns_a[3];
+  size_t l;
+
+  uCmd_InitTable(_bench_stats_table, UCMD_GET_TABLE_SIZE(_bench_stats_table));
+  uCmdStats_Init(&stats);
+  printf("\n--- uCmd_Run with statistics (ns/cmd) ---\n");
+  printf("%-14s %9s %9s %9s\n", "line", "off", "counts", "timed");
+  for(l = 0; l < sizeof(line_a) / sizeof(line_a[0]); l++) {
+    uCmd_SetStats(NULL);
+    uCmd_SetClock(NULL);
+    ns_a[0] = _bench_run(line_a[l]);
+    uCmd_SetStats(&stats);
+    ns_a[1] = _bench_run(line_a[l]);
+    uCmd_SetClock(_bench_clock);
+    ns_a[2] = _bench_run(line_a[l]);
+    printf("%-14s %9.1f %9.1f %9.1f\n", line_a[l], ns_a[0], ns_a[1], ns_a[2]);
+  }
+  uCmd_SetStats(NULL);
+  uCmd_SetClock(NULL);
+}
+
+#if UCMD_TRACE
+/* uCmd_Run with the trace detached and attached. No clock is set, so that the
+ * stores of the record are timed alone; the timestamp adds one clock read. */
+void bench_trace(void) {
+  static const char* const line_a[] = {"pwm f2000 d50", "reset", "nope"};
+  static uCmdTrace_s trace;
+  double off, on;
+  size_t l;
+
+  uCmd_InitTable(_bench_stats_table, UCMD_GET_TABLE_SIZE(_bench_stats_table));
+  uCmdTrace_Init(&trace);
+  printf("\n--- uCmd_Run with the trace (ns/cmd) ---\n");
+  printf("%-14s %9s %9s\n", "line", "off", "traced");
+  for(l = 0; l < sizeof(line_a) / sizeof(line_a[0]); l++) {
+    uCmd_SetTrace(NULL);
+    off = _bench_run(line_a[l]);
+    uCmd_SetTrace(&trace);
+    on = _bench_run(line_a[l]);
+    printf("%-14s %9.1f %9.1f\n", line_a[l], off, on);
+  }
+  uCmd_SetTrace(NULL);
+}
+#endif
@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "utils.h"
+
+#define BENCH_STRTO_ITER (1000000)
+#define BENCH_STRTO_STRS (64)
+#define BENCH_STRTO_ROUNDS (5) // Best round is kept.
+
+/* Best ns per call of _call over all strings of the current row. */
+#define BENCH_STRTO_BEST(_best, _call) do { \
+    size_t _round, _i; \
+    uint64_t _start; \
+    double _ns; \
+    (_best) = 1e30; \
+    for(_round = 0; _round < BENCH_STRTO_ROUNDS; _round++) { \
+      _start = bench_now_ns(); \
+      for(_i = 0; _i < BENCH_STRTO_ITER; _i++) { \
+        const char* str = strs[_i % BENCH_STRTO_STRS]; \
+        size_t len = lens[_i % BENCH_STRTO_STRS]; \
+        (void)len; \
+        bench_sink += (_call); \
+      } \
+      _ns = (double)(bench_now_ns() - _start) / BENCH_STRTO_ITER; \
+      (_best) = (_ns < (_best)) ? _ns : (_best); \
+    } \
+  } while(0)
+
+/* Digit loop strtou32 used before the SWAR engine, kept as the reference.
+ * Not inlined, so that it pays the same call as strntou32 in utils.c. */
+__attribute__((noinline)) static ErrCode_e _strntou32_loop(const char* rawstr, size_t slen, uint32_t* data) {
+  size_t i;
+  ErrCode_e ret = E_GENERIC;
+  if((rawstr) && (data) && (slen)) {
+    ret = E_OK;
+    *data = 0;
+    for(i = 0; (i < slen) && ((rawstr[i] >= '0') && rawstr[i] <= '9'); i++) {
+      *data = (uint32_t)(rawstr[i] - '0') + 10 * (*data);
+    }
+    if(i < slen) {
+      ret = E_OUT_OF_RANGE;
+    }
+  } else {
+    ret = (rawstr && data) ? E_INV_SIZE : E_NULL_PTR;
+  }
+  return ret;
+}
+
+void bench_strto(void) {
+  static const size_t digits_a[] = {1, 3, 5, 8, 10};
+  static char strs[BENCH_STRTO_STRS][16];
+  static size_t lens[BENCH_STRTO_STRS];
+  uint32_t num = 0;
+  double loop_ns, swar_ns, libc_ns;
+  size_t d, i, j;
+
+  printf("\n--- Decimal conversion (ns/call) ---\n");
+  printf("%6s %10s %10s %10s\n", "digits", "loop", "strntou32", "strtoul");
+  srand(1);
+  for(d = 0; d < sizeof(digits_a) / sizeof(digits_a[0]); d++) {
+    for(i = 0; i < BENCH_STRTO_STRS; i++) {
+      /* Leading digit below 4 keeps 10 digit values within uint32_t. */
+      strs[i][0] = (char)('1' + (rand() % 3));
+      for(j = 1; j < digits_a[d]; j++) {
+        strs[i][j] = (char)('0' + (rand() % 10));
+      }
+      strs[i][j] = '\0';
+      lens[i] = j;
+    }
+
+    BENCH_STRTO_BEST(loop_ns, (_strntou32_loop(str, len, &num), num));
+    BENCH_STRTO_BEST(swar_ns, (strntou32(str, len, &num), num));
+    BENCH_STRTO_BEST(libc_ns, strtoul(str, NULL, 10));
+
+    printf("%6zu %10.2f %10.2f %10.2f\n", digits_a[d], loop_ns, swar_ns, libc_ns);
+  }
+}
@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+#include "err.h"
+#include "tx.h"
+
+#define BENCH_TX_ITER (200000)
+#define BENCH_TX_ROUNDS (5) // Best round is kept.
+
+/* Host stand-in for the UART: bytes handed over by the drain hook land here. */
+typedef struct BenchSink {
+  uint8_t buff[TX_BUFF_SIZE];
+  size_t total;
+} BenchSink_s;
+
+static BenchSink_s _sink_s;
+static FILE* _null_f;
+
+/* DMA stand-in: each contiguous chunk is copied in one transfer, which */
+/* completes at once. */
+static void _drain_dma(TxCtx_s* ctx, void* arg) {
+  BenchSink_s* sink = arg;
+  const uint8_t* data;
+  size_t len;
+  while((len = TxCtx_Peek(ctx, &data)) != 0) {
+    memcpy(sink->buff, data, len);
+    sink->total += len;
+    TxCtx_Consume(ctx, len);
+  }
+}
+
+/* Transmit empty interrupt stand-in: one byte per interrupt. */
+static void _drain_isr(TxCtx_s* ctx, void* arg) {
+  BenchSink_s* sink = arg;
+  uint8_t byte;
+  while(TxCtx_GetByte(ctx, &byte)) {
+    sink->buff[sink->total++ % TX_BUFF_SIZE] = byte;
+  }
+}
+
+/* Main loop side only: the transfer runs elsewhere, the bytes are released */
+/* without being copied. */
+static void _drain_none(TxCtx_s* ctx, void* arg) {
+  BenchSink_s* sink = arg;
+  sink->total += TxCtx_GetCnt(ctx);
+  TxCtx_Consume(ctx, TX_BUFF_SIZE);
+}
+
+/* Report formatted through stdio, as print_err used to do. */
+static void _print_err_stdio(char* msg, ErrCode_e err, int flush) {
+  static const char* const err_a[] = {
+    "OK", "NULL Pointer", "Invalid Argument", "Invalid Size", "Too Large", "Too Small",
+    "Out of Range", "Not Implemented", "Not Found", "Internal", "Generic", "Not Initialized",
+  };
+  fprintf(_null_f, "%s: %s.\n\r", msg, err_a[err]);
+  if(flush) {
+    fflush(_null_f);
+  }
+}
+
+static double _bench_tx(Tx_Drain drain, size_t* bytes) {
+  double best = 1e30;
+  size_t round, i;
+  Tx_Init();
+  Tx_SetDrain(drain, &_sink_s);
+  for(round = 0; round < BENCH_TX_ROUNDS; round++) {
+    uint64_t start;
+    double ns;
+    _sink_s.total = 0;
+    start = bench_now_ns();
+    for(i = 0; i < BENCH_TX_ITER; i++) {
+      print_err("motor_cmd", (ErrCode_e)(i % E_LAST_ELEM));
+    }
+    ns = (double)(bench_now_ns() - start) / BENCH_TX_ITER;
+    best = (ns < best) ? ns : best;
+  }
+  bench_sink += Tx_GetDropCnt();
+  *bytes = _sink_s.total;
+  return best;
+}
+
+static double _bench_stdio(int flush) {
+  double best = 1e30;
+  size_t round, i;
+  for(round = 0; round < BENCH_TX_ROUNDS; round++) {
+    uint64_t start = bench_now_ns();
+    double ns;
+    for(i = 0; i < BENCH_TX_ITER; i++) {
+      _print_err_stdio("motor_cmd", (ErrCode_e)(i % E_LAST_ELEM), flush);
+    }
+    ns = (double)(bench_now_ns() - start) / BENCH_TX_ITER;
+    best = (ns < best) ? ns : best;
+  }
+  return best;
+}
+
+void bench_tx(void) {
+  static const char* const kind_a[] = {"tx main", "tx dma", "tx isr", "fprintf", "fflush"};
+  double ns_a[5];
+  size_t bytes = 0;
+  size_t kind;
+
+  _null_f = fopen("/dev/null", "w");
+  if(!_null_f) {
+    return;
+  }
+  ns_a[0] = _bench_tx(_drain_none, &bytes);
+  ns_a[1] = _bench_tx(_drain_dma, &bytes);
+  ns_a[2] = _bench_tx(_drain_isr, &bytes);
+  ns_a[3] = _bench_stdio(0);
+  ns_a[4] = _bench_stdio(1);
+  fclose(_null_f);
+  Tx_Init();
+
+  /* All kinds write the same messages, the last Tx run counted their bytes. */
+  printf("\n--- print_err (%zu bytes/msg) ---\n", bytes / BENCH_TX_ITER);
+  printf("%8s %9s %9s\n", "kind", "ns/msg", "MB/s");
+  for(kind = 0; kind < sizeof(kind_a) / sizeof(kind_a[0]); kind++) {
+    printf("%8s %9.1f %9.1f\n", kind_a[kind], ns_a[kind], 1e3 * (double)bytes / BENCH_TX_ITER / ns_a[kind]);
+  }
+}
@@ -0,0 +1,154 @@
+/* Command table of a typical device, 100 commands taking 0 to 4 arguments,
+ * built as a full uCmdInfo_s table or as a packed one (-DSIZE_PACKED=1) to
+ * compare their footprint. See the size target of the Makefile. */
+#include "ucmd.h"
+
+/* Each entry is Cn(name, type, argname, ...) for a command of n arguments. */
+#define SIZE_TABLE(C0, C1, C2, C3, C4) \
+  C0(led_get) \
+  C2(led_set, I16, 'h', U16, 's') \
+  C1(led_on, I16, 'l') \
+  C0(led_off) \
+  C3(led_cfg, U8, 'p', I16, 'u', U8, 's') \
+  C0(motor_get) \
+  C2(motor_set, I16, 'p', U16, 'i') \
+  C1(motor_on, I32, 'g') \
+  C0(motor_off) \
+  C4(motor_cfg, U16, 'p', U16, 'r', I32, 'm', U16, 'u') \
+  C0(pwm_get) \
+  C2(pwm_set, I32, 'q', U8, 'm') \
+  C1(pwm_on, U8, 'v') \
+  C0(pwm_off) \
+  C4(pwm_cfg, U32, 'f', U8, 'y', U32, 's', I8, 'b') \
+  C0(adc_get) \
+  C2(adc_set, I8, 't', I32, 'x') \
+  C1(adc_on, I8, 'z') \
+  C0(adc_off) \
+  C3(adc_cfg, I16, 'm', I8, 'x', U16, 'z') \
+  C0(dac_get) \
+  C2(dac_set, U8, 'l', U16, 'd') \
+  C1(dac_on, U16, 'p') \
+  C0(dac_off) \
+  C3(dac_cfg, I32, 'i', U32, 'v', I8, 'n') \
+  C0(uart_get) \
+  C2(uart_set, I16, 'q', U32, 'm') \
+  C1(uart_on, I16, 'r') \
+  C0(uart_off) \
+  C3(uart_cfg, U32, 'n', I32, 's', U8, 'h') \
+  C0(spi_get) \
+  C2(spi_set, I32, 'i', I32, 't') \
+  C1(spi_on, I32, 'f') \
+  C0(spi_off) \
+  C3(spi_cfg, I16, 'k', U8, 'r', I32, 's') \
+  C0(i2c_get) \
+  C2(i2c_set, I32, 'u', I16, 'g') \
+  C1(i2c_on, U32, 'i') \
+  C0(i2c_off) \
+  C3(i2c_cfg, I32, 'd', I8, 'c', U8, 'p') \
+  C0(gpio_get) \
+  C2(gpio_set, U8, 'l', I8, 'z') \
+  C1(gpio_on, U8, 'e') \
+  C0(gpio_off) \
+  C3(gpio_cfg, I8, 'j', U8, 'n', U8, 'y') \
+  C0(timer_get) \
+  C2(timer_set, U8, 't', I8, 'y') \
+  C1(timer_on, I16, 'w') \
+  C0(timer_off) \
+  C4(timer_cfg, U16, 'k', U8, 'r', U32, 'i', U8, 'q') \
+  C0(rtc_get) \
+  C2(rtc_set, I16, 'c', I16, 'd') \
+  C1(rtc_on, U16, 'b') \
+  C0(rtc_off) \
+  C3(rtc_cfg, U32, 'n', U16, 'j', I32, 't') \
+  C0(flash_get) \
+  C2(flash_set, U32, 'b', U32, 'k') \
+  C1(flash_on, I8, 'e') \
+  C0(flash_off) \
+  C3(flash_cfg, I8, 'm', I32, 'o', I16, 'q') \
+  C0(eeprom_get) \
+  C2(eeprom_set, U8, 'v', I16, 'r') \
+  C1(eeprom_on, I16, 'z') \
+  C0(eeprom_off) \
+  C3(eeprom_cfg, I32, 'i', I32, 'n', U16, 'u') \
+  C0(temp_get) \
+  C2(temp_set, U32, 'j', I16, 'n') \
+  C1(temp_on, I16, 'j') \
+  C0(temp_off) \
+  C3(temp_cfg, I8, 'k', I16, 'a', U32, 'z') \
+  C0(fan_get) \
+  C2(fan_set, I16, 'a', I16, 'm') \
+  C1(fan_on, U16, 'u') \
+  C0(fan_off) \
+  C3(fan_cfg, I8, 'b', U32, 'u', I32, 'k') \
+  C0(relay_get) \
+  C2(relay_set, I32, 'l', U32, 't') \
+  C1(relay_on, I8, 'x') \
+  C0(relay_off) \
+  C3(relay_cfg, I32, 'a', U8, 's', U32, 'b') \
+  C0(buzzer_get) \
+  C2(buzzer_set, I8, 'i', U32, 'u') \
+  C1(buzzer_on, I16, 's') \
+  C0(buzzer_off) \
+  C3(buzzer_cfg, U16, 'k', U32, 'f', U32, 'l') \
+  C0(lcd_get) \
+  C2(lcd_set, U32, 't', I8, 'i') \
+  C1(lcd_on, U8, 'd') \
+  C0(lcd_off) \
+  C3(lcd_cfg, U16, 's', U32, 'v', I16, 'x') \
+  C0(key_get) \
+  C2(key_set, U32, 'h', U16, 'u') \
+  C1(key_on, U16, 'k') \
+  C0(key_off) \
+  C3(key_cfg, I32, 'v', U8, 'n', U8, 'u') \
+  C0(log_get) \
+  C2(log_set, U32, 't', I32, 'k') \
+  C1(log_on, I8, 'h') \
+  C0(log_off) \
+  C3(log_cfg, U32, 'z', I32, 'f', I32, 'c')
+
+static ErrCode_e size_cb(Arg_s* args, void* usrargs) {
+  (void)args;
+  (void)usrargs;
+  return E_OK;
+}
+
+#if !SIZE_PACKED
+#define FULL_ARG(_t, _a) {E_ARG_##_t, _a}
+#define FULL0(_n) {#_n, size_cb, UCMD_ARG_NONE, UCMD_ARG_USER_NONE},
+#define FULL1(_n, _t0, _a0) {#_n, size_cb, {FULL_ARG(_t0, _a0)}, UCMD_ARG_USER_NONE},
+#define FULL2(_n, _t0, _a0, _t1, _a1) \
+  {#_n, size_cb, {FULL_ARG(_t0, _a0), FULL_ARG(_t1, _a1)}, UCMD_ARG_USER_NONE},
+#define FULL3(_n, _t0, _a0, _t1, _a1, _t2, _a2) \
+  {#_n, size_cb, {FULL_ARG(_t0, _a0), FULL_ARG(_t1, _a1), FULL_ARG(_t2, _a2)}, UCMD_ARG_USER_NONE},
+#define FULL4(_n, _t0, _a0, _t1, _a1, _t2, _a2, _t3, _a3) \
+  {#_n, size_cb, {FULL_ARG(_t0, _a0), FULL_ARG(_t1, _a1), FULL_ARG(_t2, _a2), FULL_ARG(_t3, _a3)}, \
+   UCMD_ARG_USER_NONE},
+
+const uCmdInfo_s size_table_a[] = {
+  SIZE_TABLE(FULL0, FULL1, FULL2, FULL3, FULL4)
+  UCMD_TABLE_END,
+};
+#else
+#define PNAME(_n, ...) #_n "\0"
+#define PARG(_t, _a) UCMD_PARG(E_ARG_##_t, _a),
+#define PARG0(_n)
+#define PARG1(_n, _t0, _a0) PARG(_t0, _a0)
+#define PARG2(_n, _t0, _a0, _t1, _a1) PARG(_t0, _a0) PARG(_t1, _a1)
+#define PARG3(_n, _t0, _a0, _t1, _a1, _t2, _a2) PARG(_t0, _a0) PARG(_t1, _a1) PARG(_t2, _a2)
+#define PARG4(_n, _t0, _a0, _t1, _a1, _t2, _a2, _t3, _a3) \
+  PARG(_t0, _a0) PARG(_t1, _a1) PARG(_t2, _a2) PARG(_t3, _a3)
+#define PCMD0(...) {size_cb, UCMD_ARG_USER_NONE, 0},
+#define PCMD1(...) {size_cb, UCMD_ARG_USER_NONE, 1},
+#define PCMD2(...) {size_cb, UCMD_ARG_USER_NONE, 2},
+#define PCMD3(...) {size_cb, UCMD_ARG_USER_NONE, 3},
+#define PCMD4(...) {size_cb, UCMD_ARG_USER_NONE, 4},
+
+static const char size_names[] = SIZE_TABLE(PNAME, PNAME, PNAME, PNAME, PNAME);
+static const uCmdPackedArg_t size_args[] = {
+  SIZE_TABLE(PARG0, PARG1, PARG2, PARG3, PARG4)
+};
+static const uCmdPackedCmd_s size_cmd_a[] = {
+  SIZE_TABLE(PCMD0, PCMD1, PCMD2, PCMD3, PCMD4)
+};
+const uCmdPacked_s size_table_s = UCMD_PACKED_TABLE(size_cmd_a, size_names, size_args);
+#endif
@@ -11,13 +11,19 @@ ErrCode_e cmd_1(Arg_s* args, void* usrargs) {
   return E_OK;
 }
 
-extern ErrCode_e _get_cmdinfo(const char* cmdstr, const uCmdTable_s * cmd_table, const uCmdInfo_s** info);
+extern ErrCode_e _get_cmd(const char* cmdstr, size_t len, const uCmdTable_s * cmd_table, size_t* idx);
 
-extern ErrCode_e _get_param(const char* rawstr, char* param, uint8_t* done);
+extern ErrCode_e _get_param(const char* rawstr, size_t* len, uint8_t* done);
 
 extern ErrCode_e _parse_string(const char* rawstr, const uCmdTable_s* table_sa, uCmdHandle_s* handle);
 
-extern ErrCode_e _get_arg(const char* rawstr, const ArgDesc_s* argdesc_a, Arg_s* arg);
+extern ErrCode_e _build_hash(const uCmdTable_s* table, uCmdHash_s* hash);
+
+extern ErrCode_e _get_arg(const char* rawstr, size_t len, const uCmdTable_s* table, size_t idx, Arg_s* arg);
+
+extern ErrCode_e _build_argidx(const uCmdTable_s* table, size_t idx, uCmdArgIdx_s* argidx);
+
+extern ErrCode_e _convert_arg(const char* rawstr, size_t len, ArgType_e argtype, uint8_t* data);
 
 void test__get_param(void) {
    /*************************************************************************/
@@ -25,37 +31,42 @@ void test__get_param(void) {
    /*************************************************************************/
    char str[] = "pwmfreq f2.33 m1";
    char str_a[][10] = { "pwmfreq", "f2.33", "m1" };
-   char name[UCMD_NAME_MAX_SIZE];
-   char* ofs = str;
+   const char* ofs = str;
    ErrCode_e res;
    uint8_t done = 0;
+   size_t len = 0;
    size_t i;
-   memset(name, 0, sizeof(name));
 
    /*************************************************************************/
    /* TEST ARGUMENT VALIDATION **********************************************/
    /*************************************************************************/
-   res = _get_param(NULL, name, &done);
+   res = _get_param(NULL, &len, &done);
    TEST_ASSERT_EQUAL_INT32((int32_t)E_NULL_PTR, (int32_t)res);
 
    res = _get_param(str, NULL, &done);
    TEST_ASSERT_EQUAL_INT32((int32_t)E_NULL_PTR, (int32_t)res);
 
-   res = _get_param(str, name, NULL);
+   res = _get_param(str, &len, NULL);
    TEST_ASSERT_EQUAL_INT32((int32_t)E_NULL_PTR, (int32_t)res);
 
+   res = _get_param(" m1", &len, &done);
+   TEST_ASSERT_EQUAL_INT32((int32_t)E_INV_SIZE, (int32_t)res);
+
    /*************************************************************************/
    /* TEST BODY AND VALIDATION **********************************************/
    /*************************************************************************/
    for (i = 0; (!done) && (i < sizeof(str_a) / 10); ++i) {
-      res = _get_param(ofs, name, &done);
+      res = _get_param(ofs, &len, &done);
       TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)res);
-      TEST_ASSERT_TRUE(strcmp(str_a[i], name) == 0);
-      ofs += strlen(name) + 1;
+      TEST_ASSERT_EQUAL_UINT32((uint32_t)strlen(str_a[i]), (uint32_t)len);
+      TEST_ASSERT_TRUE(strncmp(str_a[i], ofs, len) == 0);
+      ofs += len + 1;
       if (i == 2) {
          TEST_ASSERT_TRUE(done);
       }
    }
+   /* Tokens are not copied, the raw string is left untouched. */
+   TEST_ASSERT_EQUAL_STRING("pwmfreq f2.33 m1", str);
 }
 
 ErrCode_e dummy_handle(Arg_s* args, void* usrargs) {
@@ -67,7 +78,7 @@ ErrCode_e dummy_handle(Arg_s* args, void* usrargs) {
    return E_OK;
 }
 
-void test__get_cmdinfo(void) {
+void test__get_cmd(void) {
    /*************************************************************************/
    /* TEST SETUP ************************************************************/
    /*************************************************************************/
@@ -86,9 +97,9 @@ void test__get_cmdinfo(void) {
 
          /* Argument Description. */
          {
-            {E_ARG_U8, 'r'},
-            {E_ARG_I16, 'q'},
-            {E_ARG_I32, 'f'},
+            UCMD_ARG_DESC(E_ARG_U8, 'r'),
+            UCMD_ARG_DESC(E_ARG_I16, 'q'),
+            UCMD_ARG_DESC(E_ARG_I32, 'f'),
          },
 
          /* User argument. */
@@ -104,9 +115,9 @@ void test__get_cmdinfo(void) {
 
          /* Argument Description. */
          {
-            {E_ARG_I32, 'p'},
-            {E_ARG_I32, 'i'},
-            {E_ARG_I32, 'd'},
+            UCMD_ARG_DESC(E_ARG_I32, 'p'),
+            UCMD_ARG_DESC(E_ARG_I32, 'i'),
+            UCMD_ARG_DESC(E_ARG_I32, 'd'),
          },
 
          /* User argument. */
@@ -122,9 +133,9 @@ void test__get_cmdinfo(void) {
 
          /* Argument Description. */
          {
-            {E_ARG_U8, 'x'},
-            {E_ARG_I16, 'y'},
-            {E_ARG_I32, 'z'},
+            UCMD_ARG_DESC(E_ARG_U8, 'x'),
+            UCMD_ARG_DESC(E_ARG_I16, 'y'),
+            UCMD_ARG_DESC(E_ARG_I32, 'z'),
          },
 
          /* User argument. */
@@ -132,9 +143,9 @@ void test__get_cmdinfo(void) {
       },
    };
 
-   uCmdTable_s cmdtable = { info_a, sizeof(info_a) / sizeof(uCmdInfo_s) };
+   uCmdTable_s cmdtable = { .info_a = info_a, .size = sizeof(info_a) / sizeof(uCmdInfo_s) };
 
-   const uCmdInfo_s* p_cmdinfo_s;
+   size_t idx;
    char cmdname[] = "pwmfreq";
    ErrCode_e ret;
 
@@ -143,35 +154,110 @@ void test__get_cmdinfo(void) {
    /*************************************************************************/
    /* TEST ARGUMENT VALIDATION **********************************************/
    /*************************************************************************/
-   ret = _get_cmdinfo(NULL, NULL, NULL);
+   ret = _get_cmd(NULL, 0, NULL, NULL);
    TEST_ASSERT_EQUAL_INT32((int32_t)E_NULL_PTR, (int32_t)ret);
 
-   ret = _get_cmdinfo("pwmfreq", NULL, NULL);
+   ret = _get_cmd("pwmfreq", 7, NULL, NULL);
    TEST_ASSERT_EQUAL_INT32((int32_t)E_NULL_PTR, (int32_t)ret);
 
    cmdtable.size = 0;
-   ret = _get_cmdinfo("pwmfreq", &cmdtable, &p_cmdinfo_s);
+   ret = _get_cmd("pwmfreq", 7, &cmdtable, &idx);
    TEST_ASSERT_EQUAL_INT32((int32_t)E_INV_SIZE, (int32_t)ret);
    cmdtable.size = sizeof(info_a) / sizeof(uCmdInfo_s);
 
    /*************************************************************************/
    /* TEST BODY AND VALIDATION **********************************************/
    /*************************************************************************/
-   ret = _get_cmdinfo(cmdname, &cmdtable, &p_cmdinfo_s);
+   ret = _get_cmd(cmdname, strlen(cmdname), &cmdtable, &idx);
    TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
-   TEST_ASSERT_TRUE(cmdtable.info_a == p_cmdinfo_s);
+   TEST_ASSERT_EQUAL_UINT32(0, idx);
 
    for (i = 0; i < sizeof(info_a) / sizeof(uCmdInfo_s); i++) {
-      ret = _get_cmdinfo(cmdname_a[i], &cmdtable, &p_cmdinfo_s);
+      ret = _get_cmd(cmdname_a[i], strlen(cmdname_a[i]), &cmdtable, &idx);
       TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
-      TEST_ASSERT_TRUE(&cmdtable.info_a[i] == p_cmdinfo_s);
+      TEST_ASSERT_EQUAL_UINT32(i, idx);
    }
 
-   // If command is non-existant, p_cmdinfo_s pointer is returned as NULL.
-   p_cmdinfo_s = &info_a[0];
-   ret = _get_cmdinfo("dummy", &cmdtable, &p_cmdinfo_s);
+   // Names are matched on the given length only.
+   ret = _get_cmd("pid f10", 3, &cmdtable, &idx);
+   TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
+   TEST_ASSERT_EQUAL_UINT32(1, idx);
+
+   ret = _get_cmd("pi", 2, &cmdtable, &idx);
+   TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
+   TEST_ASSERT_EQUAL_UINT32(cmdtable.size, idx);
+
+   // If command is non-existant, the table size is returned as index.
+   idx = 0;
+   ret = _get_cmd("dummy", 5, &cmdtable, &idx);
+   TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
+   TEST_ASSERT_EQUAL_UINT32(cmdtable.size, idx);
+}
+
+void test__build_hash(void) {
+   /*************************************************************************/
+   /* TEST SETUP ************************************************************/
+   /*************************************************************************/
+
+   uint8_t i;
+
+   const uCmdInfo_s info_a[] = {
+      { "pwmfreq", dummy_handle, UCMD_ARG_NONE, NULL },
+      { "pid", dummy_handle, UCMD_ARG_NONE, NULL },
+      { "ctrlmode", dummy_handle, UCMD_ARG_NONE, NULL },
+      { "reset", dummy_handle, UCMD_ARG_NONE, NULL },
+      { "pid", dummy_handle, UCMD_ARG_NONE, NULL },
+      { "a", dummy_handle, UCMD_ARG_NONE, NULL },
+      { "b", dummy_handle, UCMD_ARG_NONE, NULL },
+      UCMD_TABLE_END,
+   };
+
+   uCmdHash_s hash;
+   uCmdTable_s cmdtable = { .info_a = info_a, .size = UCMD_GET_TABLE_SIZE(info_a) };
+   size_t idx;
+   ErrCode_e ret;
+
+   /*************************************************************************/
+   /* TEST ARGUMENT VALIDATION **********************************************/
+   /*************************************************************************/
+   ret = _build_hash(NULL, &hash);
+   TEST_ASSERT_EQUAL_INT32((int32_t)E_NULL_PTR, (int32_t)ret);
+
+   ret = _build_hash(&cmdtable, NULL);
+   TEST_ASSERT_EQUAL_INT32((int32_t)E_NULL_PTR, (int32_t)ret);
+
+   cmdtable.size = UCMD_TABLE_MAX_SIZE + 1;
+   ret = _build_hash(&cmdtable, &hash);
+   TEST_ASSERT_EQUAL_INT32((int32_t)E_INV_SIZE, (int32_t)ret);
+   cmdtable.size = UCMD_GET_TABLE_SIZE(info_a);
+
+   /*************************************************************************/
+   /* TEST BODY AND VALIDATION **********************************************/
+   /*************************************************************************/
+   ret = _build_hash(&cmdtable, &hash);
+   TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
+   cmdtable.hash = &hash;
+
+   for (i = 0; i < UCMD_GET_TABLE_SIZE(info_a); i++) {
+      ret = _get_cmd(info_a[i].cmdname, strlen(info_a[i].cmdname), &cmdtable, &idx);
+      TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
+      TEST_ASSERT_TRUE(idx < cmdtable.size);
+      TEST_ASSERT_EQUAL_STRING(info_a[i].cmdname, info_a[idx].cmdname);
+   }
+
+   // Duplicated names resolve to the first entry, as with a linear scan.
+   ret = _get_cmd("pid", 3, &cmdtable, &idx);
+   TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
+   TEST_ASSERT_EQUAL_UINT32(1, idx);
+
+   idx = 0;
+   ret = _get_cmd("dummy", 5, &cmdtable, &idx);
+   TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
+   TEST_ASSERT_EQUAL_UINT32(cmdtable.size, idx);
+
+   ret = _get_cmd("pidd", 4, &cmdtable, &idx);
    TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
-   TEST_ASSERT_TRUE(p_cmdinfo_s == NULL);
+   TEST_ASSERT_EQUAL_UINT32(cmdtable.size, idx);
 }
 
 void test__parse_string(void) {
@@ -191,9 +277,9 @@ void test__parse_string(void) {
 
          /* Argument Description. */
          {
-            {E_ARG_U8, 'r'},
-            {E_ARG_I16, 'q'},
-            {E_ARG_I32, 'f'},
+            UCMD_ARG_DESC(E_ARG_U8, 'r'),
+            UCMD_ARG_DESC(E_ARG_I16, 'q'),
+            UCMD_ARG_DESC(E_ARG_I32, 'f'),
          },
          /* User argument. */
          NULL,
@@ -208,9 +294,9 @@ void test__parse_string(void) {
 
          /* Argument Description. */
          {
-            {E_ARG_I32, 'p'},
-            {E_ARG_I32, 'i'},
-            {E_ARG_I32, 'd'},
+            UCMD_ARG_DESC(E_ARG_I32, 'p'),
+            UCMD_ARG_DESC(E_ARG_I32, 'i'),
+            UCMD_ARG_DESC(E_ARG_I32, 'd'),
          },
          /* User argument. */
          NULL,
@@ -225,9 +311,9 @@ void test__parse_string(void) {
 
          /* Argument Description. */
          {
-            {E_ARG_U8, 'x'},
-            {E_ARG_I16, 'y'},
-            {E_ARG_I32, 'z'},
+            UCMD_ARG_DESC(E_ARG_U8, 'x'),
+            UCMD_ARG_DESC(E_ARG_I16, 'y'),
+            UCMD_ARG_DESC(E_ARG_I32, 'z'),
          },
          /* User argument. */
          NULL,
@@ -237,10 +323,11 @@ void test__parse_string(void) {
    ErrCode_e ret;
    char rawstr[UCMD_RAW_STR_MAX_SIZE] = "pwmfreq f233 r10 q-40";
 
-   uCmdTable_s table_sa;
-   uCmdHandle_s handle = { NULL, {{0}}, NULL };
+   uCmdTable_s table_sa = { .info_a = NULL, .size = 0 };
+   uCmdHandle_s handle = { .callback = NULL, .userarg = NULL, .cmd = 0 };
    table_sa.info_a = &info_a[0];
    table_sa.size = 0;
+   table_sa.hash = NULL;
    ret = E_NULL_PTR;
    /*************************************************************************/
    /* TEST ARGUMENT VALIDATION **********************************************/
@@ -260,6 +347,7 @@ void test__parse_string(void) {
    table_sa.size = sizeof(info_a) / sizeof(uCmdInfo_s);
    ret = _parse_string(rawstr, &table_sa, &handle);
    TEST_ASSERT_TRUE(handle.callback == dummy_handle);
+   TEST_ASSERT_EQUAL_UINT16(0, handle.cmd);
    TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
 }
 
@@ -270,14 +358,16 @@ void test__get_arg(void) {
 
    uint8_t i;
 
-   const ArgDesc_s argdesc_a[] = {
-      {E_ARG_U8, 'a'},
-      {E_ARG_I8, 'b'},
-      {E_ARG_U16, 'c'},
-      {E_ARG_I16, 'd'},
-      {E_ARG_U32, 'e'},
-      {E_ARG_I32, 'f'},
+   /* One argument per command. */
+   const uCmdInfo_s info_a[] = {
+      {"a", cmd_1, {UCMD_ARG_DESC(E_ARG_U8, 'a')}, NULL},
+      {"b", cmd_1, {UCMD_ARG_DESC(E_ARG_I8, 'b')}, NULL},
+      {"c", cmd_1, {UCMD_ARG_DESC(E_ARG_U16, 'c')}, NULL},
+      {"d", cmd_1, {UCMD_ARG_DESC(E_ARG_I16, 'd')}, NULL},
+      {"e", cmd_1, {UCMD_ARG_DESC(E_ARG_U32, 'e')}, NULL},
+      {"f", cmd_1, {UCMD_ARG_DESC(E_ARG_I32, 'f')}, NULL},
    };
+   uCmdTable_s table = { .info_a = info_a, .size = sizeof(info_a) / sizeof(uCmdInfo_s) };
 
    const char argname_a[][UCMD_RAW_STR_MAX_SIZE] = {
       "a20",
@@ -304,11 +394,11 @@ void test__get_arg(void) {
    /* TEST BODY AND VALIDATION **********************************************/
    /*************************************************************************/
    ret = E_OK;
-   for (i = 0; i < sizeof(argdesc_a) / sizeof(ArgDesc_s); i++) {
-      ret = _get_arg(argname_a[i], &argdesc_a[i], &arg);
+   for (i = 0; i < table.size; i++) {
+      ret = _get_arg(argname_a[i], strlen(argname_a[i]), &table, i, &arg);
       TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
       frombytes((void*)&arg.data[0], ((size_t)UCMD_ARG_BYTES_MAX_SIZE), (void*)&buf, sizeof(buf));
-      switch (argdesc_a[i].argtype) {
+      switch (info_a[i].argdesc[0].argtype) {
       case E_ARG_U8:
          TEST_ASSERT_TRUE(!memcmp((void*)&buf, (void*)&values[i], sizeof(uint8_t)));
          break;
@@ -334,6 +424,146 @@ void test__get_arg(void) {
    }
 }
 
+void test__build_argidx(void) {
+   /*************************************************************************/
+   /* TEST SETUP ************************************************************/
+   /*************************************************************************/
+   const uCmdInfo_s info_a[] = {
+      /* Names are deliberately not in mask order. */
+      {"cmd", cmd_1, {UCMD_ARG_DESC(E_ARG_U8, 'z'), UCMD_ARG_DESC(E_ARG_I16, '0'), UCMD_ARG_DESC(E_ARG_U32, 'A'), UCMD_ARG_DESC(E_ARG_I8, 'c')}, NULL},
+      {"none", cmd_1, UCMD_ARG_NONE, NULL},
+      {"gap", cmd_1, {UCMD_ARG_DESC(E_ARG_U8, 'x'), UCMD_ARG_DESC(E_ARG_U8, 0), UCMD_ARG_DESC(E_ARG_U8, 'y')}, NULL},
+      {"dup", cmd_1, {UCMD_ARG_DESC(E_ARG_U8, 'x'), UCMD_ARG_DESC(E_ARG_U16, 'x')}, NULL},
+      {"name", cmd_1, {UCMD_ARG_DESC(E_ARG_U8, '_')}, NULL},
+      {"type", cmd_1, {UCMD_ARG_DESC(E_ARG_STR, 's')}, NULL},
+      {"size", cmd_1, {{E_ARG_U16, 's', 0, 4}}, NULL},
+   };
+   const char* argstr_a[] = { "z7", "09", "A10", "c-1" };
+   uCmdTable_s table = { .info_a = info_a, .size = sizeof(info_a) / sizeof(uCmdInfo_s) };
+   uCmdArgIdx_s argidx;
+   Arg_s args[UCMD_ARG_MAX_SIZE];
+   ErrCode_e ret;
+   size_t i;
+
+   /*************************************************************************/
+   /* TEST ARGUMENT VALIDATION **********************************************/
+   /*************************************************************************/
+   ret = _build_argidx(NULL, 0, &argidx);
+   TEST_ASSERT_EQUAL_INT32((int32_t)E_NULL_PTR, (int32_t)ret);
+   ret = _build_argidx(&table, 0, NULL);
+   TEST_ASSERT_EQUAL_INT32((int32_t)E_NULL_PTR, (int32_t)ret);
+
+   /*************************************************************************/
+   /* TEST BODY AND VALIDATION **********************************************/
+   /*************************************************************************/
+   ret = _build_argidx(&table, 0, &argidx);
+   TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
+   /* '0' is bit 0, 'A' bit 10, 'c' bit 38 and 'z' bit 61. */
+   TEST_ASSERT_TRUE(argidx.mask == ((1ull << 0) | (1ull << 10) | (1ull << 38) | (1ull << 61)));
+   TEST_ASSERT_EQUAL_UINT8(1, argidx.slot[0]);
+   TEST_ASSERT_EQUAL_UINT8(2, argidx.slot[1]);
+   TEST_ASSERT_EQUAL_UINT8(3, argidx.slot[2]);
+   TEST_ASSERT_EQUAL_UINT8(0, argidx.slot[3]);
+
+   /* Indexed arguments land in the same slots as with the linear scan. */
+   table.argidx = &argidx;
+   memset(args, 0, sizeof(args));
+   for (i = 0; i < sizeof(argstr_a) / sizeof(argstr_a[0]); i++) {
+      ret = _get_arg(argstr_a[i], strlen(argstr_a[i]), &table, 0, args);
+      TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
+      TEST_ASSERT_TRUE(args[i].is_valid);
+      TEST_ASSERT_EQUAL_PTR(&info_a[0].argdesc[i], args[i].desc);
+   }
+   TEST_ASSERT_EQUAL_UINT8(7, UCMD_ARG(args, 0, uint8_t));
+   TEST_ASSERT_EQUAL_INT16(9, UCMD_ARG(args, 1, int16_t));
+   TEST_ASSERT_EQUAL_UINT32(10, UCMD_ARG(args, 2, uint32_t));
+   TEST_ASSERT_EQUAL_INT8(-1, UCMD_ARG(args, 3, int8_t));
+   ret = _get_arg("b1", 2, &table, 0, args);
+   TEST_ASSERT_EQUAL_INT32((int32_t)E_NOT_FOUND, (int32_t)ret);
+   ret = _get_arg("-1", 2, &table, 0, args);
+   TEST_ASSERT_EQUAL_INT32((int32_t)E_NOT_FOUND, (int32_t)ret);
+
+   ret = _build_argidx(&table, 1, &argidx);
+   TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
+   TEST_ASSERT_TRUE(argidx.mask == 0);
+
+   /* Unused descriptors may sit between used ones. */
+   ret = _build_argidx(&table, 2, &argidx);
+   TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
+   TEST_ASSERT_EQUAL_UINT8(0, argidx.slot[0]);
+   TEST_ASSERT_EQUAL_UINT8(2, argidx.slot[1]);
+
+   ret = _build_argidx(&table, 3, &argidx);
+   TEST_ASSERT_EQUAL_INT32((int32_t)E_INV_ARG, (int32_t)ret);
+   ret = _build_argidx(&table, 4, &argidx);
+   TEST_ASSERT_EQUAL_INT32((int32_t)E_INV_ARG, (int32_t)ret);
+   ret = _build_argidx(&table, 5, &argidx);
+   TEST_ASSERT_EQUAL_INT32((int32_t)E_INV_ARG, (int32_t)ret);
+   ret = _build_argidx(&table, 6, &argidx);
+   TEST_ASSERT_EQUAL_INT32((int32_t)E_INV_SIZE, (int32_t)ret);
+}
+
+void test__convert_arg(void) {
+   /*************************************************************************/
+   /* TEST SETUP ************************************************************/
+   /*************************************************************************/
+   typedef struct {
+      ArgType_e argtype;
+      const char* str;
+      ErrCode_e ret;
+      int64_t value;
+   } ConvertCase_s;
+
+   const ConvertCase_s case_a[] = {
+      { E_ARG_U8, "255", E_OK, 255 },
+      { E_ARG_U8, "256", E_OUT_OF_RANGE, 0 },
+      { E_ARG_U16, "65535", E_OK, 65535 },
+      { E_ARG_U16, "65536", E_OUT_OF_RANGE, 0 },
+      { E_ARG_U32, "4294967295", E_OK, 4294967295 },
+      { E_ARG_U32, "4294967296", E_OUT_OF_RANGE, 0 },
+      { E_ARG_I8, "-128", E_OK, -128 },
+      { E_ARG_I8, "127", E_OK, 127 },
+      { E_ARG_I8, "-129", E_OUT_OF_RANGE, 0 },
+      { E_ARG_I8, "128", E_OUT_OF_RANGE, 0 },
+      { E_ARG_I16, "-32768", E_OK, -32768 },
+      { E_ARG_I16, "32768", E_OUT_OF_RANGE, 0 },
+      { E_ARG_I32, "-2147483648", E_OK, INT32_MIN },
+      { E_ARG_I32, "2147483648", E_OUT_OF_RANGE, 0 },
+      { E_ARG_U8, "1x", E_OUT_OF_RANGE, 0 },
+      { E_ARG_STR, "abc", E_NOT_IMPLEMENTED, 0 },
+   };
+
+   ErrCode_e ret;
+   uint8_t data[UCMD_ARG_BYTES_MAX_SIZE];
+   uint8_t expected[UCMD_ARG_BYTES_MAX_SIZE];
+   size_t i;
+
+   /*************************************************************************/
+   /* TEST BODY AND VALIDATION **********************************************/
+   /*************************************************************************/
+   for (i = 0; i < sizeof(case_a) / sizeof(ConvertCase_s); i++) {
+      /* Bytes past the argument width and failed conversions keep the fill. */
+      memset(data, 0xA5, sizeof(data));
+      memset(expected, 0xA5, sizeof(expected));
+      ret = _convert_arg(case_a[i].str, strlen(case_a[i].str), case_a[i].argtype, data);
+      TEST_ASSERT_EQUAL_INT32((int32_t)case_a[i].ret, (int32_t)ret);
+      if (ret == E_OK) {
+         switch (case_a[i].argtype) {
+         case E_ARG_U8: case E_ARG_I8:
+            expected[0] = (uint8_t)case_a[i].value;
+            break;
+         case E_ARG_U16: case E_ARG_I16:
+            *(uint16_t*)expected = (uint16_t)case_a[i].value;
+            break;
+         default:
+            *(uint32_t*)expected = (uint32_t)case_a[i].value;
+            break;
+         }
+      }
+      TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, data, sizeof(data));
+   }
+}
+
 struct MyAppData {
    uint8_t a;
    int16_t b;
@@ -389,9 +619,9 @@ void test_cmd(void) {
 
          /* Argument Description. */
          {
-            {E_ARG_U8, 'r'},
-            {E_ARG_I16, 'q'},
-            {E_ARG_I32, 'f'},
+            UCMD_ARG_DESC(E_ARG_U8, 'r'),
+            UCMD_ARG_DESC(E_ARG_I16, 'q'),
+            UCMD_ARG_DESC(E_ARG_I32, 'f'),
          },
 
          /* User Arguments */
@@ -407,9 +637,9 @@ void test_cmd(void) {
 
          /* Argument Description. */
          {
-            {E_ARG_I32, 'p'},
-            {E_ARG_I32, 'i'},
-            {E_ARG_I32, 'd'},
+            UCMD_ARG_DESC(E_ARG_I32, 'p'),
+            UCMD_ARG_DESC(E_ARG_I32, 'i'),
+            UCMD_ARG_DESC(E_ARG_I32, 'd'),
 
          },
 
@@ -0,0 +1,145 @@
+#include "unity.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "fmt.h"
+#include "utils.h"
+
+/*-----------------------------------------------------------------------------
+ *  Helper functions and variables.
+ *-----------------------------------------------------------------------------*/
+
+/* 10^exp, exp up to 9. */
+static uint32_t pow10_helper(uint8_t exp) {
+  uint32_t val = 1;
+  while(exp--) {
+    val *= 10u;
+  }
+  return val;
+}
+
+/* Values spread over every digit count. */
+static uint32_t helper_rand_u32(void) {
+  return ((uint32_t)rand() << 17 ^ (uint32_t)rand()) >> (rand() % 32);
+}
+
+/*-----------------------------------------------------------------------------
+ *  Tests.
+ *-----------------------------------------------------------------------------*/
+void test_u32tostr(void) {
+  char buf[FMT_U32_MAX_LEN + 1];
+  size_t len = 0;
+  TEST_ASSERT_EQUAL(E_OK, u32tostr(buf, sizeof(buf), 0, &len));
+  TEST_ASSERT_EQUAL_STRING("0", buf);
+  TEST_ASSERT_EQUAL_UINT(1, len);
+  TEST_ASSERT_EQUAL(E_OK, u32tostr(buf, sizeof(buf), UINT32_MAX, &len));
+  TEST_ASSERT_EQUAL_STRING("4294967295", buf);
+  TEST_ASSERT_EQUAL_UINT(FMT_U32_MAX_LEN, len);
+  TEST_ASSERT_EQUAL(E_OK, u32tostr(buf, sizeof(buf), 1000000000u, NULL));
+  TEST_ASSERT_EQUAL_STRING("1000000000", buf);
+  /* The terminator needs room too, the buffer is untouched otherwise. */
+  TEST_ASSERT_EQUAL(E_OK, u32tostr(buf, 4, 999, &len));
+  TEST_ASSERT_EQUAL_STRING("999", buf);
+  TEST_ASSERT_EQUAL(E_INV_SIZE, u32tostr(buf, 4, 1000, &len));
+  TEST_ASSERT_EQUAL_STRING("999", buf);
+  TEST_ASSERT_EQUAL(E_INV_SIZE, u32tostr(buf, 0, 0, &len));
+  TEST_ASSERT_EQUAL(E_NULL_PTR, u32tostr(NULL, sizeof(buf), 0, &len));
+}
+
+void test_i32tostr(void) {
+  char buf[FMT_I32_MAX_LEN + 1];
+  size_t len = 0;
+  TEST_ASSERT_EQUAL(E_OK, i32tostr(buf, sizeof(buf), INT32_MIN, &len));
+  TEST_ASSERT_EQUAL_STRING("-2147483648", buf);
+  TEST_ASSERT_EQUAL_UINT(FMT_I32_MAX_LEN, len);
+  TEST_ASSERT_EQUAL(E_OK, i32tostr(buf, sizeof(buf), INT32_MAX, &len));
+  TEST_ASSERT_EQUAL_STRING("2147483647", buf);
+  TEST_ASSERT_EQUAL(E_OK, i32tostr(buf, sizeof(buf), -7, &len));
+  TEST_ASSERT_EQUAL_STRING("-7", buf);
+  TEST_ASSERT_EQUAL_UINT(2, len);
+  TEST_ASSERT_EQUAL(E_INV_SIZE, i32tostr(buf, 3, -10, &len));
+}
+
+void test_u32tohex(void) {
+  char buf[FMT_HEX32_MAX_LEN + 1];
+  size_t len = 0;
+  TEST_ASSERT_EQUAL(E_OK, u32tohex(buf, sizeof(buf), 0, 0, &len));
+  TEST_ASSERT_EQUAL_STRING("0", buf);
+  TEST_ASSERT_EQUAL(E_OK, u32tohex(buf, sizeof(buf), 0xDEADBEEFu, 0, &len));
+  TEST_ASSERT_EQUAL_STRING("DEADBEEF", buf);
+  TEST_ASSERT_EQUAL_UINT(8, len);
+  TEST_ASSERT_EQUAL(E_OK, u32tohex(buf, sizeof(buf), 0xA5u, 4, &len));
+  TEST_ASSERT_EQUAL_STRING("00A5", buf);
+  TEST_ASSERT_EQUAL_UINT(4, len);
+  /* Width is a minimum, digits are never cut. */
+  TEST_ASSERT_EQUAL(E_OK, u32tohex(buf, sizeof(buf), 0x12345u, 2, &len));
+  TEST_ASSERT_EQUAL_STRING("12345", buf);
+  TEST_ASSERT_EQUAL(E_INV_ARG, u32tohex(buf, sizeof(buf), 0, FMT_HEX32_MAX_LEN + 1, &len));
+  TEST_ASSERT_EQUAL(E_INV_SIZE, u32tohex(buf, 4, 0, 4, &len));
+  TEST_ASSERT_EQUAL(E_NULL_PTR, u32tohex(NULL, sizeof(buf), 0, 0, &len));
+}
+
+void test_fixtostr(void) {
+  char buf[FMT_FIX_MAX_LEN + 1];
+  size_t len = 0;
+  TEST_ASSERT_EQUAL(E_OK, fixtostr(buf, sizeof(buf), 12345, 2, &len));
+  TEST_ASSERT_EQUAL_STRING("123.45", buf);
+  TEST_ASSERT_EQUAL_UINT(6, len);
+  TEST_ASSERT_EQUAL(E_OK, fixtostr(buf, sizeof(buf), -5, 2, &len));
+  TEST_ASSERT_EQUAL_STRING("-0.05", buf);
+  TEST_ASSERT_EQUAL(E_OK, fixtostr(buf, sizeof(buf), 7, 0, &len));
+  TEST_ASSERT_EQUAL_STRING("7", buf);
+  TEST_ASSERT_EQUAL(E_OK, fixtostr(buf, sizeof(buf), 1000, 3, &len));
+  TEST_ASSERT_EQUAL_STRING("1.000", buf);
+  TEST_ASSERT_EQUAL(E_OK, fixtostr(buf, sizeof(buf), INT32_MIN, FMT_FIX_MAX_DECIMALS, &len));
+  TEST_ASSERT_EQUAL_STRING("-2.147483648", buf);
+  TEST_ASSERT_EQUAL_UINT(FMT_FIX_MAX_LEN, len);
+  TEST_ASSERT_EQUAL(E_INV_ARG, fixtostr(buf, sizeof(buf), 1, FMT_FIX_MAX_DECIMALS + 1, &len));
+  TEST_ASSERT_EQUAL(E_INV_SIZE, fixtostr(buf, 5, 12345, 2, &len));
+}
+
+void test_fmt_matches_snprintf(void) {
+  char buf[FMT_FIX_MAX_LEN + 1];
+  char ref[24];
+  uint32_t val, num;
+  int32_t sval;
+  uint8_t arg;
+  size_t len;
+  int i;
+  srand(7);
+  for(i = 0; i < 20000; i++) {
+    val = helper_rand_u32();
+    sval = (rand() & 1) ? -(int32_t)(val >> 1) : (int32_t)(val >> 1);
+    TEST_ASSERT_EQUAL(E_OK, u32tostr(buf, sizeof(buf), val, &len));
+    snprintf(ref, sizeof(ref), "%" PRIu32, val);
+    TEST_ASSERT_EQUAL_STRING(ref, buf);
+    TEST_ASSERT_EQUAL_UINT(strlen(ref), len);
+    /* Formatting is the inverse of parsing. */
+    TEST_ASSERT_EQUAL(E_OK, strntou32(buf, len, &num));
+    TEST_ASSERT_EQUAL_UINT32(val, num);
+
+    TEST_ASSERT_EQUAL(E_OK, i32tostr(buf, sizeof(buf), sval, &len));
+    snprintf(ref, sizeof(ref), "%" PRId32, sval);
+    TEST_ASSERT_EQUAL_STRING(ref, buf);
+
+    arg = (uint8_t)(rand() % (FMT_HEX32_MAX_LEN + 1));
+    TEST_ASSERT_EQUAL(E_OK, u32tohex(buf, sizeof(buf), val, arg, &len));
+    snprintf(ref, sizeof(ref), "%0*" PRIX32, (int)arg, val);
+    TEST_ASSERT_EQUAL_STRING(ref, buf);
+
+    arg = (uint8_t)(rand() % (FMT_FIX_MAX_DECIMALS + 1));
+    TEST_ASSERT_EQUAL(E_OK, fixtostr(buf, sizeof(buf), sval, arg, &len));
+    /* Exact within the precision of a double. */
+    snprintf(ref, sizeof(ref), "%.*f", (int)arg, (double)sval / pow10_helper(arg));
+    TEST_ASSERT_EQUAL_STRING(ref, buf);
+  }
+}
+
+void test_fmt_all_tests(void) {
+  RUN_TEST(test_u32tostr);
+  RUN_TEST(test_i32tostr);
+  RUN_TEST(test_u32tohex);
+  RUN_TEST(test_fixtostr);
+  RUN_TEST(test_fmt_matches_snprintf);
+}
@@ -2,8 +2,10 @@
 #include <stdbool.h>
 #include <string.h>
 #include <stdio.h>
+#include <pthread.h>
 #include "line.h"
 #include "ucmd.h"
+#include "tx.h"
 
 uint8_t simple_cmd_callback_is_called = 0;
 uint8_t cmd_no_args_callback_is_called = 0;
@@ -56,8 +58,8 @@ static ErrCode_e cmd_one_arg_callback(Arg_s* args, void* usrargs) {
 const uCmdInfo_s info_a[] = {
   {"a", simple_cmd_callback, UCMD_ARG_NONE, UCMD_ARG_USER_NONE},
   {"cmd_no_args", cmd_no_args_callback, UCMD_ARG_NONE, UCMD_ARG_USER_NONE},
-  {"cmd_one_arg", cmd_one_arg_callback, {{E_ARG_U8, 'q'}}, UCMD_ARG_USER_NONE},
-  {"cmd_max_arg", cmd_max_arg_callback, {{E_ARG_U8, 'q'}, {E_ARG_I8, 'r'}, {E_ARG_I32, 's'}, {E_ARG_I16, 'z'}}, UCMD_ARG_USER_NONE},
+  {"cmd_one_arg", cmd_one_arg_callback, {UCMD_ARG_DESC(E_ARG_U8, 'q')}, UCMD_ARG_USER_NONE},
+  {"cmd_max_arg", cmd_max_arg_callback, {UCMD_ARG_DESC(E_ARG_U8, 'q'), UCMD_ARG_DESC(E_ARG_I8, 'r'), UCMD_ARG_DESC(E_ARG_I32, 's'), UCMD_ARG_DESC(E_ARG_I16, 'z')}, UCMD_ARG_USER_NONE},
   /* Keep this element last. Denotes end of table. */
   UCMD_TABLE_END,
 };
@@ -144,10 +146,1123 @@ void test_char_command_max_diff_positions(void) {
   TEST_ASSERT_EQUAL_INT16(max_args_s.z, -32000);
 }
 
+void test_out_of_range_argument(void) {
+  helper_setup();
+  cmd_one_arg_callback_is_called = 0;
+  /* q is a uint8_t. The command is rejected rather than run with 300 & 0xFF. */
+  TEST_ASSERT_EQUAL(E_OUT_OF_RANGE, uCmd_Run("cmd_one_arg q300"));
+  TEST_ASSERT_EQUAL(E_OUT_OF_RANGE, uCmd_Run("cmd_one_arg q-1"));
+  TEST_ASSERT_EQUAL_UINT8(0, cmd_one_arg_callback_is_called);
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("cmd_one_arg q255"));
+  TEST_ASSERT_EQUAL_UINT8(255, cmd_one_arg_callback_is_called);
+}
+
+static struct MaxArgs bound_args_s;
+static const struct MaxArgs* bound_args_seen = NULL;
+static uint8_t bound_args_valid = 0;
+
+/* Bound arguments are already in place, the callback only uses them. */
+static ErrCode_e cmd_bound_callback(Arg_s* args, void* usrargs) {
+  const struct MaxArgs* max = (const struct MaxArgs*)usrargs;
+  size_t i;
+  bound_args_seen = max;
+  bound_args_valid = 0;
+  for(i = 0; i < UCMD_ARG_MAX_SIZE; i++) {
+    bound_args_valid |= (uint8_t)(UCMD_ARG_IS_VALID(args, i) << i);
+  }
+  return E_OK;
+}
+
+void test_bound_arguments(void) {
+  const uCmdInfo_s bound_a[] = {
+    {"cmd_bound", cmd_bound_callback, {
+      UCMD_ARG_BIND(E_ARG_U8, 'q', struct MaxArgs, q),
+      UCMD_ARG_BIND(E_ARG_I8, 'r', struct MaxArgs, r),
+      UCMD_ARG_BIND(E_ARG_I32, 's', struct MaxArgs, s),
+      UCMD_ARG_BIND(E_ARG_I16, 'z', struct MaxArgs, z)}, &bound_args_s},
+    {"cmd_no_struct", cmd_bound_callback, {
+      UCMD_ARG_BIND(E_ARG_U8, 'q', struct MaxArgs, q)}, UCMD_ARG_USER_NONE},
+    UCMD_TABLE_END,
+  };
+  memset((void*)&bound_args_s, 0, sizeof(bound_args_s));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_InitTable(bound_a, UCMD_GET_TABLE_SIZE(bound_a)));
+
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("cmd_bound q255 r-128 s2300 z-32000"));
+  TEST_ASSERT_EQUAL_PTR(&bound_args_s, bound_args_seen);
+  TEST_ASSERT_EQUAL_UINT8(255, bound_args_s.q);
+  TEST_ASSERT_EQUAL_INT8(-128, bound_args_s.r);
+  TEST_ASSERT_EQUAL_INT32(2300, bound_args_s.s);
+  TEST_ASSERT_EQUAL_INT16(-32000, bound_args_s.z);
+
+  /* Arguments that are not given keep their value, and the array only
+     holds those of the line. */
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("cmd_bound s-7"));
+  TEST_ASSERT_EQUAL_UINT8(255, bound_args_s.q);
+  TEST_ASSERT_EQUAL_INT32(-7, bound_args_s.s);
+  TEST_ASSERT_EQUAL_INT16(-32000, bound_args_s.z);
+  TEST_ASSERT_EQUAL_HEX8(0x04, bound_args_valid);
+
+  /* Values that do not fit are rejected before reaching the member. */
+  TEST_ASSERT_EQUAL(E_OUT_OF_RANGE, uCmd_Run("cmd_bound z40000"));
+  TEST_ASSERT_EQUAL_INT16(-32000, bound_args_s.z);
+
+  /* A line that fails leaves the struct alone, even the members given
+     before the faulty token. */
+  bound_args_seen = NULL;
+  TEST_ASSERT_EQUAL(E_OUT_OF_RANGE, uCmd_Run("cmd_bound q1 s5 z40000"));
+  TEST_ASSERT_EQUAL(E_NOT_FOUND, uCmd_Run("cmd_bound q1 s5 x1"));
+  TEST_ASSERT_NULL(bound_args_seen);
+  TEST_ASSERT_EQUAL_UINT8(255, bound_args_s.q);
+  TEST_ASSERT_EQUAL_INT32(-7, bound_args_s.s);
+  TEST_ASSERT_EQUAL_INT16(-32000, bound_args_s.z);
+
+  TEST_ASSERT_EQUAL(E_NULL_PTR, uCmd_Run("cmd_no_struct q1"));
+}
+
+/* One command more than an instance can index, all of them "a". */
+static const uCmdInfo_s* helper_oversized_table(void) {
+  static uCmdInfo_s big_a[UCMD_TABLE_MAX_SIZE + 1];
+  size_t i;
+  for(i = 0; i < UCMD_TABLE_MAX_SIZE + 1; i++) {
+    memcpy((void*)&big_a[i], &info_a[0], sizeof(uCmdInfo_s));
+  }
+  return big_a;
+}
+
+void test_invalid_table_is_rejected(void) {
+  /* Binding an int16_t member to an 8-bit argument is a size mismatch. */
+  const uCmdInfo_s bad_size_a[] = {
+    {"cmd_bad_size", cmd_bound_callback, {
+      UCMD_ARG_BIND(E_ARG_I8, 'z', struct MaxArgs, z)}, &bound_args_s},
+    UCMD_TABLE_END,
+  };
+  const uCmdInfo_s dup_name_a[] = {
+    {"a", simple_cmd_callback, UCMD_ARG_NONE, UCMD_ARG_USER_NONE},
+    {"cmd_dup", cmd_one_arg_callback, {UCMD_ARG_DESC(E_ARG_U8, 'q'), UCMD_ARG_DESC(E_ARG_U16, 'q')}, UCMD_ARG_USER_NONE},
+    UCMD_TABLE_END,
+  };
+  const uCmdInfo_s bad_name_a[] = {
+    {"cmd_dash", cmd_one_arg_callback, {UCMD_ARG_DESC(E_ARG_U8, '-')}, UCMD_ARG_USER_NONE},
+    UCMD_TABLE_END,
+  };
+  const uCmdInfo_s str_arg_a[] = {
+    {"cmd_str", cmd_one_arg_callback, {UCMD_ARG_DESC(E_ARG_STR, 's')}, UCMD_ARG_USER_NONE},
+    UCMD_TABLE_END,
+  };
+  TEST_ASSERT_EQUAL(E_INV_SIZE, uCmd_InitTable(bad_size_a, UCMD_GET_TABLE_SIZE(bad_size_a)));
+  TEST_ASSERT_EQUAL(E_NOT_INITIALIZED, uCmd_Run("cmd_bad_size z1"));
+  TEST_ASSERT_EQUAL(E_INV_ARG, uCmd_InitTable(dup_name_a, UCMD_GET_TABLE_SIZE(dup_name_a)));
+  /* Nothing of a rejected table is installed. */
+  TEST_ASSERT_EQUAL(E_NOT_INITIALIZED, uCmd_Run("a"));
+  TEST_ASSERT_EQUAL(E_INV_ARG, uCmd_InitTable(bad_name_a, UCMD_GET_TABLE_SIZE(bad_name_a)));
+  TEST_ASSERT_EQUAL(E_INV_ARG, uCmd_InitTable(str_arg_a, UCMD_GET_TABLE_SIZE(str_arg_a)));
+  TEST_ASSERT_EQUAL(E_INV_SIZE, uCmd_InitTable(helper_oversized_table(), UCMD_TABLE_MAX_SIZE + 1));
+  TEST_ASSERT_EQUAL(E_NOT_INITIALIZED, uCmd_Run("a"));
+}
+
+void test_pipelined_commands(void) {
+  helper_setup();
+  cmd_one_arg_callback_is_called = 0;
+  /* Commands arrive back to back before the main loop gets to run. */
+  helper_fill_buff("cmd_no_args");
+  helper_fill_buff("cmd_one_arg q7");
+  helper_fill_buff("a");
+  TEST_ASSERT_EQUAL_UINT8(3, Line_GetQueueCnt());
+  uCmd_Loop();
+  TEST_ASSERT_TRUE(cmd_no_args_callback_is_called);
+  TEST_ASSERT_EQUAL_UINT8(0, cmd_one_arg_callback_is_called);
+  uCmd_Loop();
+  TEST_ASSERT_EQUAL_UINT8(7, cmd_one_arg_callback_is_called);
+  TEST_ASSERT_FALSE(simple_cmd_callback_is_called);
+  uCmd_Loop();
+  TEST_ASSERT_TRUE(simple_cmd_callback_is_called);
+  TEST_ASSERT_FALSE(Line_IsCmplt());
+  TEST_ASSERT_EQUAL_UINT16(0, Line_GetDropCnt());
+}
+
+static ErrCode_e count_callback(Arg_s* args, void* usrargs) {
+  uint32_t* count = (uint32_t*)usrargs;
+  *count += UCMD_ARG_IS_VALID(args, 0) ? UCMD_ARG(args, 0, uint8_t) : 1;
+  return E_OK;
+}
+
+static void helper_fill_ctx(LineCtx_s* line, const char* str) {
+  LineCtx_AddChars(line, (const uint8_t*)str, strlen(str));
+  LineCtx_AddChar(line, '\n');
+}
+
+void test_independent_channels(void) {
+  uint32_t uart_cnt = 0;
+  uint32_t usb_cnt = 0;
+  const uCmdInfo_s uart_a[] = {
+    {"inc", count_callback, {UCMD_ARG_DESC(E_ARG_U8, 'n')}, &uart_cnt},
+    UCMD_TABLE_END,
+  };
+  const uCmdInfo_s usb_a[] = {
+    {"add", count_callback, {UCMD_ARG_DESC(E_ARG_U8, 'n')}, &usb_cnt},
+    UCMD_TABLE_END,
+  };
+  uCmdCtx_s uart, usb;
+  LineCtx_s uart_line, usb_line;
+  helper_setup();
+  TEST_ASSERT_EQUAL(E_OK, uCmdCtx_InitTable(&uart, uart_a, UCMD_GET_TABLE_SIZE(uart_a)));
+  TEST_ASSERT_EQUAL(E_OK, uCmdCtx_InitTable(&usb, usb_a, UCMD_GET_TABLE_SIZE(usb_a)));
+  LineCtx_Init(&uart_line);
+  LineCtx_Init(&usb_line);
+  /* Characters of both channels are interleaved, as two interrupts would do. */
+  LineCtx_AddChars(&uart_line, (const uint8_t*)"in", 2);
+  LineCtx_AddChars(&usb_line, (const uint8_t*)"add n", 5);
+  LineCtx_AddChars(&uart_line, (const uint8_t*)"c n3\n", 5);
+  LineCtx_AddChars(&usb_line, (const uint8_t*)"40\n", 3);
+  helper_fill_ctx(&uart_line, "add n1");
+  TEST_ASSERT_EQUAL_UINT8(2, LineCtx_GetQueueCnt(&uart_line));
+  TEST_ASSERT_EQUAL_UINT8(1, LineCtx_GetQueueCnt(&usb_line));
+  TEST_ASSERT_FALSE(Line_IsCmplt());
+  TEST_ASSERT_EQUAL(E_OK, uCmdCtx_Loop(&uart, &uart_line));
+  TEST_ASSERT_EQUAL(E_OK, uCmdCtx_Loop(&usb, &usb_line));
+  TEST_ASSERT_EQUAL_UINT32(3, uart_cnt);
+  TEST_ASSERT_EQUAL_UINT32(40, usb_cnt);
+  /* Each instance only knows its own table. */
+  TEST_ASSERT_EQUAL(E_INTERNAL, uCmdCtx_Loop(&uart, &uart_line));
+  TEST_ASSERT_EQUAL(E_INTERNAL, uCmdCtx_Run(&usb, "inc"));
+  /* The default instance is left alone. */
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("a"));
+  TEST_ASSERT_TRUE(simple_cmd_callback_is_called);
+  TEST_ASSERT_EQUAL(E_NULL_PTR, uCmdCtx_Run(NULL, "a"));
+  TEST_ASSERT_EQUAL(E_NULL_PTR, uCmdCtx_Loop(&uart, NULL));
+}
+
+static uint16_t pwm_freq[2];
+static uCmdCtx_s motor_ctx, motor1_ctx, motor2_ctx;
+
+static ErrCode_e pwm_callback(Arg_s* args, void* usrargs) {
+  *(uint16_t*)usrargs = UCMD_ARG(args, 0, uint16_t);
+  return E_OK;
+}
+
+/* "motor 1 pwm f2000": each word but the last selects a sub-table. */
+static void helper_nested_setup(void) {
+  static const uCmdInfo_s motor1_a[] = {
+    {"pwm", pwm_callback, {UCMD_ARG_DESC(E_ARG_U16, 'f')}, &pwm_freq[0]},
+    {"stop", cmd_no_args_callback, UCMD_ARG_NONE, UCMD_ARG_USER_NONE},
+  };
+  static const uCmdInfo_s motor2_a[] = {
+    {"pwm", pwm_callback, {UCMD_ARG_DESC(E_ARG_U16, 'f')}, &pwm_freq[1]},
+  };
+  static const uCmdInfo_s motor_a[] = {
+    UCMD_SUBTABLE("1", &motor1_ctx),
+    UCMD_SUBTABLE("2", &motor2_ctx),
+  };
+  static const uCmdInfo_s top_a[] = {
+    {"a", simple_cmd_callback, UCMD_ARG_NONE, UCMD_ARG_USER_NONE},
+    UCMD_SUBTABLE("motor", &motor_ctx),
+  };
+  /* The parent only keeps a pointer, so tables can be installed in any order. */
+  TEST_ASSERT_EQUAL(E_OK, uCmd_InitTable(top_a, UCMD_GET_TABLE_SIZE(top_a)));
+  TEST_ASSERT_EQUAL(E_OK, uCmdCtx_InitTable(&motor_ctx, motor_a, UCMD_GET_TABLE_SIZE(motor_a)));
+  TEST_ASSERT_EQUAL(E_OK, uCmdCtx_InitTable(&motor1_ctx, motor1_a, UCMD_GET_TABLE_SIZE(motor1_a)));
+  TEST_ASSERT_EQUAL(E_OK, uCmdCtx_InitTable(&motor2_ctx, motor2_a, UCMD_GET_TABLE_SIZE(motor2_a)));
+  memset(pwm_freq, 0, sizeof(pwm_freq));
+  simple_cmd_callback_is_called = 0;
+  cmd_no_args_callback_is_called = 0;
+}
+
+static const char* const nested_lines_a[] = {
+  "motor 1 pwm f2000", "motor 2 pwm f300", "motor 1 stop", "a", "motor", "motor 1", "motor 3 pwm f1",
+  "motor 2 stop", "motor 1 pwm f70000", "motor 1 pwm x1", "motor  1 pwm f1", "motor pwm f1", "motor 1 pwm ",
+};
+static const ErrCode_e nested_ret_a[] = {
+  E_OK, E_OK, E_OK, E_OK, E_INTERNAL, E_INTERNAL, E_INTERNAL,
+  E_INTERNAL, E_OUT_OF_RANGE, E_NOT_FOUND, E_INTERNAL, E_INTERNAL, E_INV_SIZE,
+};
+
+void test_nested_tables(void) {
+  const uCmdInfo_s no_ctx_a[] = {
+    UCMD_SUBTABLE("motor", UCMD_ARG_USER_NONE),
+  };
+  const uCmdInfo_s with_args_a[] = {
+    {"motor", uCmd_SubTable, {UCMD_ARG_DESC(E_ARG_U8, 'n')}, &motor_ctx},
+  };
+  size_t i;
+  helper_nested_setup();
+  for(i = 0; i < sizeof(nested_lines_a) / sizeof(nested_lines_a[0]); i++) {
+    TEST_ASSERT_EQUAL_MESSAGE(nested_ret_a[i], uCmd_Run(nested_lines_a[i]), nested_lines_a[i]);
+  }
+  TEST_ASSERT_EQUAL_UINT16(2000, pwm_freq[0]);
+  TEST_ASSERT_EQUAL_UINT16(300, pwm_freq[1]);
+  TEST_ASSERT_TRUE(cmd_no_args_callback_is_called);
+  TEST_ASSERT_TRUE(simple_cmd_callback_is_called);
+
+  /* Sub-tables are only used once installed. */
+  TEST_ASSERT_EQUAL(E_NULL_PTR, uCmdCtx_InitTable(&motor2_ctx, NULL, 0));
+  TEST_ASSERT_EQUAL(E_INTERNAL, uCmd_Run("motor 2 pwm f1"));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("motor 1 pwm f1"));
+
+  TEST_ASSERT_EQUAL(E_INV_ARG, uCmdCtx_InitTable(&motor_ctx, no_ctx_a, UCMD_GET_TABLE_SIZE(no_ctx_a)));
+  TEST_ASSERT_EQUAL(E_INV_ARG, uCmdCtx_InitTable(&motor_ctx, with_args_a, UCMD_GET_TABLE_SIZE(with_args_a)));
+  TEST_ASSERT_EQUAL(E_INTERNAL, uCmd_SubTable(NULL, &motor_ctx));
+}
+
+#if UCMD_STREAM
+void test_stream_nested_tables(void) {
+  const char* str;
+  size_t i;
+  helper_nested_setup();
+  for(i = 0; i < sizeof(nested_lines_a) / sizeof(nested_lines_a[0]); i++) {
+    for(str = nested_lines_a[i]; *str; str++) {
+      uCmd_StreamChar(*str);
+    }
+    uCmd_StreamChar('\n');
+    TEST_ASSERT_EQUAL_MESSAGE(nested_ret_a[i], uCmd_StreamLoop(), nested_lines_a[i]);
+  }
+  TEST_ASSERT_EQUAL_UINT16(2000, pwm_freq[0]);
+  TEST_ASSERT_EQUAL_UINT16(300, pwm_freq[1]);
+  TEST_ASSERT_TRUE(cmd_no_args_callback_is_called);
+  TEST_ASSERT_TRUE(simple_cmd_callback_is_called);
+}
+#endif
+
+#if UCMD_REGISTRY
+static uint32_t reg_led_cnt = 0;
+static uint32_t reg_fan_cnt = 0;
+
+/* Declared next to their callbacks as a driver module would. */
+UCMD_REGISTER(reg_led, count_callback, &reg_led_cnt, UCMD_ARG_DESC(E_ARG_U8, 'n'));
+UCMD_REGISTER(reg_fan, count_callback, &reg_fan_cnt);
+UCMD_REGISTER(reg_max, cmd_max_arg_callback, UCMD_ARG_USER_NONE,
+              UCMD_ARG_DESC(E_ARG_U8, 'q'), UCMD_ARG_DESC(E_ARG_I8, 'r'), UCMD_ARG_DESC(E_ARG_I32, 's'), UCMD_ARG_DESC(E_ARG_I16, 'z'));
+
+void test_registered_commands(void) {
+  uCmdCtx_s ctx;
+  helper_setup();
+  reg_led_cnt = 0;
+  reg_fan_cnt = 0;
+  memset((void*)&max_args_s, 0, sizeof(max_args_s));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_InitRegistered());
+  helper_fill_buff("reg_led n5");
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Loop());
+  TEST_ASSERT_EQUAL_UINT32(5, reg_led_cnt);
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("reg_fan"));
+  TEST_ASSERT_EQUAL_UINT32(1, reg_fan_cnt);
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("reg_max z-32000 s2300 r-128 q255"));
+  TEST_ASSERT_EQUAL_UINT8(255, max_args_s.q);
+  TEST_ASSERT_EQUAL_INT8(-128, max_args_s.r);
+  TEST_ASSERT_EQUAL_INT32(2300, max_args_s.s);
+  TEST_ASSERT_EQUAL_INT16(-32000, max_args_s.z);
+  /* Only registered commands are installed. */
+  TEST_ASSERT_EQUAL(E_INTERNAL, uCmd_Run("a"));
+  TEST_ASSERT_EQUAL(E_NOT_FOUND, uCmd_Run("reg_fan n1"));
+
+  TEST_ASSERT_EQUAL(E_OK, uCmdCtx_InitRegistered(&ctx));
+  TEST_ASSERT_EQUAL(E_OK, uCmdCtx_Run(&ctx, "reg_led n2"));
+  TEST_ASSERT_EQUAL_UINT32(7, reg_led_cnt);
+  TEST_ASSERT_EQUAL(E_NULL_PTR, uCmdCtx_InitRegistered(NULL));
+}
+#endif
+
+#define CHANNEL_CNT (3)
+#define CHANNEL_LINES (2000)
+
+typedef struct Channel {
+  uCmdCtx_s cmd;
+  LineCtx_s line;
+  uint32_t count;
+  uCmdInfo_s table[2];
+} Channel_s;
+
+static void* channel_thread(void* arg) {
+  Channel_s* ch = (Channel_s*)arg;
+  uint32_t i;
+  for(i = 0; i < CHANNEL_LINES; i++) {
+    helper_fill_ctx(&ch->line, "cnt n1");
+    while(LineCtx_IsCmplt(&ch->line)) {
+      uCmdCtx_Loop(&ch->cmd, &ch->line);
+    }
+  }
+  return NULL;
+}
+
+void test_channels_in_threads(void) {
+  static Channel_s channels[CHANNEL_CNT];
+  pthread_t threads[CHANNEL_CNT];
+  int i;
+  for(i = 0; i < CHANNEL_CNT; i++) {
+    const uCmdInfo_s table[2] = {
+      {"cnt", count_callback, {UCMD_ARG_DESC(E_ARG_U8, 'n')}, &channels[i].count},
+      UCMD_TABLE_END,
+    };
+    memcpy((void*)channels[i].table, (const void*)table, sizeof(table));
+    channels[i].count = 0;
+    LineCtx_Init(&channels[i].line);
+    uCmdCtx_InitTable(&channels[i].cmd, channels[i].table, UCMD_GET_TABLE_SIZE(table));
+  }
+  for(i = 0; i < CHANNEL_CNT; i++) {
+    pthread_create(&threads[i], NULL, channel_thread, &channels[i]);
+  }
+  for(i = 0; i < CHANNEL_CNT; i++) {
+    pthread_join(threads[i], NULL);
+    TEST_ASSERT_EQUAL_UINT32(CHANNEL_LINES, channels[i].count);
+    TEST_ASSERT_EQUAL_UINT16(0, LineCtx_GetDropCnt(&channels[i].line));
+  }
+}
+
+#if UCMD_STREAM
+static void helper_stream(const char* str) {
+  while(*str != '\0') {
+    uCmd_StreamChar(*str++);
+  }
+  uCmd_StreamChar('\n');
+}
+
+void test_stream_matches_run(void) {
+  static const char* const lines_a[] = {
+    "a", "cmd_no_args", "cmd_one_arg q7", "cmd_one_arg q255",
+    "cmd_max_arg q1 r-2 s-300000 z-5", "cmd_max_arg z3 s2147483647 r127 q0",
+    "cmd_max_arg s-2147483648", "cmd_max_arg s2147483648", "cmd_max_arg r--1",
+    "cmd_max_arg r-", "cmd_max_arg r1-", "cmd_one_arg q256", "cmd_one_arg q-1",
+    "cmd_one_arg q", "cmd_one_arg q1x", "cmd_one_arg q99999999999", "cmd_one_arg x1",
+    "cmd_one_arg q1 ", "cmd_one_arg  q1", "cmd_no_args q1", "cmd_one", "cmd_one_args",
+    "cmd_", "b", "aa", "cmd_no_args_and_more_than_sixteen",
+  };
+  struct MaxArgs run_s;
+  ErrCode_e run, stream;
+  size_t i;
+  helper_setup();
+  for(i = 0; i < sizeof(lines_a) / sizeof(lines_a[0]); i++) {
+    memset(&max_args_s, 0, sizeof(max_args_s));
+    cmd_one_arg_callback_is_called = 0;
+    run = uCmd_Run(lines_a[i]);
+    run_s = max_args_s;
+
+    memset(&max_args_s, 0, sizeof(max_args_s));
+    helper_stream(lines_a[i]);
+    stream = uCmd_StreamLoop();
+    TEST_ASSERT_EQUAL_MESSAGE(run, stream, lines_a[i]);
+    TEST_ASSERT_EQUAL_MEMORY_MESSAGE(&run_s, &max_args_s, sizeof(run_s), lines_a[i]);
+  }
+  TEST_ASSERT_TRUE(simple_cmd_callback_is_called);
+  TEST_ASSERT_TRUE(cmd_no_args_callback_is_called);
+  TEST_ASSERT_EQUAL_UINT16(0, uCmd_GetStreamDropCnt());
+}
+
+void test_stream_pipelined_commands(void) {
+  uint32_t i;
+  helper_setup();
+  cmd_one_arg_callback_is_called = 0;
+  /* Blanks and CRLF between lines are skipped, as in the Line queue. */
+  helper_stream("\r\n  cmd_no_args\r");
+  helper_stream("cmd_one_arg q7");
+  helper_stream(" a");
+  TEST_ASSERT_EQUAL(E_OK, uCmd_StreamLoop());
+  TEST_ASSERT_TRUE(cmd_no_args_callback_is_called);
+  TEST_ASSERT_EQUAL_UINT8(0, cmd_one_arg_callback_is_called);
+  TEST_ASSERT_EQUAL(E_OK, uCmd_StreamLoop());
+  TEST_ASSERT_EQUAL_UINT8(7, cmd_one_arg_callback_is_called);
+  TEST_ASSERT_FALSE(simple_cmd_callback_is_called);
+  TEST_ASSERT_EQUAL(E_OK, uCmd_StreamLoop());
+  TEST_ASSERT_TRUE(simple_cmd_callback_is_called);
+
+  /* Failed lines take a slot too, their error is returned at dispatch. A line
+     that starts while the queue is full is dropped whole. */
+  for(i = 0; i < UCMD_STREAM_QUEUE_DEPTH; i++) {
+    helper_stream("b");
+  }
+  helper_stream("cmd_one_arg q9");
+  TEST_ASSERT_EQUAL_UINT16(1, uCmd_GetStreamDropCnt());
+  for(i = 0; i < UCMD_STREAM_QUEUE_DEPTH; i++) {
+    TEST_ASSERT_EQUAL(E_INTERNAL, uCmd_StreamLoop());
+  }
+  TEST_ASSERT_EQUAL(E_OK, uCmd_StreamLoop());
+  TEST_ASSERT_EQUAL_UINT8(7, cmd_one_arg_callback_is_called);
+}
+
+/* The parser never sees a table it has no name order for. */
+void test_stream_oversized_table(void) {
+  TEST_ASSERT_EQUAL(E_INV_SIZE, uCmd_InitTable(helper_oversized_table(), UCMD_TABLE_MAX_SIZE + 1));
+  TEST_ASSERT_EQUAL(E_NOT_INITIALIZED, uCmd_StreamChar('a'));
+  TEST_ASSERT_EQUAL(E_NOT_INITIALIZED, uCmd_StreamChar('\n'));
+  TEST_ASSERT_EQUAL(E_NOT_INITIALIZED, uCmd_StreamLoop());
+  TEST_ASSERT_EQUAL(E_NOT_INITIALIZED, uCmd_Run("a"));
+  /* A table that fits works on both paths. */
+  TEST_ASSERT_EQUAL(E_OK, uCmd_InitTable(helper_oversized_table(), UCMD_TABLE_MAX_SIZE));
+  simple_cmd_callback_is_called = 0;
+  helper_stream("a");
+  TEST_ASSERT_EQUAL(E_OK, uCmd_StreamLoop());
+  TEST_ASSERT_TRUE(simple_cmd_callback_is_called);
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("a"));
+}
+
+void test_stream_bound_arguments(void) {
+  const uCmdInfo_s bound_a[] = {
+    {"cmd_bound", cmd_bound_callback, {
+      UCMD_ARG_BIND(E_ARG_U8, 'q', struct MaxArgs, q),
+      UCMD_ARG_BIND(E_ARG_I32, 's', struct MaxArgs, s)}, &bound_args_s},
+    {"cmd_no_struct", cmd_bound_callback, {
+      UCMD_ARG_BIND(E_ARG_U8, 'q', struct MaxArgs, q)}, UCMD_ARG_USER_NONE},
+    UCMD_TABLE_END,
+  };
+  uCmdCtx_s ctx;
+  uCmdStream_s stream;
+  const char* str;
+  memset((void*)&bound_args_s, 0, sizeof(bound_args_s));
+  TEST_ASSERT_EQUAL(E_OK, uCmdCtx_InitTable(&ctx, bound_a, UCMD_GET_TABLE_SIZE(bound_a)));
+  uCmdStream_Init(&stream);
+  for(str = "cmd_bound s-9 q200\ncmd_bound s70000\ncmd_bound q300\ncmd_no_struct q1\n"; *str; str++) {
+    TEST_ASSERT_EQUAL(E_OK, uCmdCtx_StreamChar(&ctx, &stream, *str));
+  }
+  /* The struct is only written when the command is run, not while received. */
+  TEST_ASSERT_EQUAL_UINT8(0, bound_args_s.q);
+  TEST_ASSERT_EQUAL(E_OK, uCmdCtx_StreamLoop(&ctx, &stream));
+  TEST_ASSERT_EQUAL_PTR(&bound_args_s, bound_args_seen);
+  TEST_ASSERT_EQUAL_UINT8(200, bound_args_s.q);
+  TEST_ASSERT_EQUAL_INT32(-9, bound_args_s.s);
+  /* Arguments that are not given keep their value. */
+  TEST_ASSERT_EQUAL(E_OK, uCmdCtx_StreamLoop(&ctx, &stream));
+  TEST_ASSERT_EQUAL_UINT8(200, bound_args_s.q);
+  TEST_ASSERT_EQUAL_INT32(70000, bound_args_s.s);
+  TEST_ASSERT_EQUAL(E_OUT_OF_RANGE, uCmdCtx_StreamLoop(&ctx, &stream));
+  TEST_ASSERT_EQUAL_UINT8(200, bound_args_s.q);
+  TEST_ASSERT_EQUAL(E_NULL_PTR, uCmdCtx_StreamLoop(&ctx, &stream));
+  TEST_ASSERT_EQUAL(E_OK, uCmdCtx_StreamLoop(&ctx, &stream));
+  TEST_ASSERT_EQUAL(E_NULL_PTR, uCmdCtx_StreamChar(NULL, &stream, 'a'));
+}
+#endif
+
+#if UCMD_PACKED
+static const char packed_names[] = "a\0" "cmd_no_args\0" "cmd_one_arg\0" "cmd_max_arg\0";
+static const uCmdPackedArg_t packed_args[] = {
+  UCMD_PARG(E_ARG_U8, 'q'),
+  UCMD_PARG(E_ARG_U8, 'q'), UCMD_PARG(E_ARG_I8, 'r'), UCMD_PARG(E_ARG_I32, 's'), UCMD_PARG(E_ARG_I16, 'z'),
+};
+static const uCmdPackedCmd_s packed_cmd_a[] = {
+  {simple_cmd_callback, UCMD_ARG_USER_NONE, 0},
+  {cmd_no_args_callback, UCMD_ARG_USER_NONE, 0},
+  {cmd_one_arg_callback, UCMD_ARG_USER_NONE, 1},
+  {cmd_max_arg_callback, UCMD_ARG_USER_NONE, 4},
+};
+/* Same commands as info_a. */
+static const uCmdPacked_s packed_s = UCMD_PACKED_TABLE(packed_cmd_a, packed_names, packed_args);
+
+void test_packed_matches_table(void) {
+  static const char* const lines_a[] = {
+    "a", "cmd_no_args", "cmd_one_arg q7", "cmd_one_arg", "cmd_one_arg q256", "cmd_one_arg x1",
+    "cmd_max_arg q1 r-2 s-300000 z-5", "cmd_max_arg z3 s2147483647 r127 q0", "cmd_max_arg r1-",
+    "cmd_no_args q1", "cmd_one", "b",
+  };
+  uCmdCtx_s full, packed;
+  struct MaxArgs full_s;
+  uint8_t full_one;
+  ErrCode_e ret;
+  size_t i;
+  TEST_ASSERT_EQUAL(E_OK, uCmdCtx_InitTable(&full, info_a, UCMD_GET_TABLE_SIZE(info_a)));
+  TEST_ASSERT_EQUAL(E_OK, uCmdCtx_InitPacked(&packed, &packed_s));
+  for(i = 0; i < sizeof(lines_a) / sizeof(lines_a[0]); i++) {
+    memset(&max_args_s, 0, sizeof(max_args_s));
+    cmd_one_arg_callback_is_called = 0;
+    ret = uCmdCtx_Run(&full, lines_a[i]);
+    full_s = max_args_s;
+    full_one = cmd_one_arg_callback_is_called;
+
+    memset(&max_args_s, 0, sizeof(max_args_s));
+    cmd_one_arg_callback_is_called = 0;
+    TEST_ASSERT_EQUAL_MESSAGE(ret, uCmdCtx_Run(&packed, lines_a[i]), lines_a[i]);
+    TEST_ASSERT_EQUAL_MEMORY_MESSAGE(&full_s, &max_args_s, sizeof(full_s), lines_a[i]);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(full_one, cmd_one_arg_callback_is_called, lines_a[i]);
+  }
+}
+
+static const ArgDesc_s* packed_desc_seen = NULL;
+
+static ErrCode_e cmd_desc_callback(Arg_s* args, void* usrargs) {
+  (void)usrargs;
+  packed_desc_seen = args[0].desc;
+  return E_OK;
+}
+
+void test_packed_table(void) {
+  static const uCmdPackedCmd_s desc_cmd_a[] = {{cmd_desc_callback, UCMD_ARG_USER_NONE, 1}};
+  static const uCmdPackedArg_t desc_args[] = {UCMD_PARG(E_ARG_U8, 'q')};
+  static const uCmdPacked_s desc_s = UCMD_PACKED_TABLE(desc_cmd_a, "desc", desc_args);
+  uCmdPacked_s table = packed_s;
+  uCmdPackedArg_t args[sizeof(packed_args)];
+#if UCMD_STREAM
+  const char* str;
+#endif
+  helper_setup();
+  TEST_ASSERT_EQUAL(E_OK, uCmd_InitPacked(&packed_s));
+  helper_fill_buff("cmd_one_arg q12");
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Loop());
+  TEST_ASSERT_EQUAL_UINT8(12, cmd_one_arg_callback_is_called);
+#if UCMD_STREAM
+  memset(&max_args_s, 0, sizeof(max_args_s));
+  for(str = "cmd_max_arg r-128 s2300 z-32000 q255\n"; *str; str++) {
+    TEST_ASSERT_EQUAL(E_OK, uCmd_StreamChar(*str));
+  }
+  TEST_ASSERT_EQUAL(E_OK, uCmd_StreamLoop());
+  TEST_ASSERT_EQUAL_UINT8(255, max_args_s.q);
+  TEST_ASSERT_EQUAL_INT16(-32000, max_args_s.z);
+#endif
+
+  /* Packed descriptors are decoded on the fly, there is none to point to. */
+  packed_desc_seen = (const ArgDesc_s*)&desc_s;
+  TEST_ASSERT_EQUAL(E_OK, uCmd_InitPacked(&desc_s));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("desc q1"));
+  TEST_ASSERT_NULL(packed_desc_seen);
+
+  /* Pools that do not match the command list. The '\0' ending the literal
+     is optional, the one ending the last name is not. */
+  table.namesz--;
+  TEST_ASSERT_EQUAL(E_OK, uCmd_InitPacked(&table));
+  table.namesz--;
+  TEST_ASSERT_EQUAL(E_INV_SIZE, uCmd_InitPacked(&table));
+  table = packed_s;
+  table.argsz--;
+  TEST_ASSERT_EQUAL(E_INV_SIZE, uCmd_InitPacked(&table));
+  table = packed_s;
+  table.size--;
+  TEST_ASSERT_EQUAL(E_INV_SIZE, uCmd_InitPacked(&table));
+  TEST_ASSERT_EQUAL(E_NOT_INITIALIZED, uCmd_Run("a"));
+
+  /* Descriptors are checked as those of a full table. */
+  memcpy(args, packed_args, sizeof(args));
+  table = packed_s;
+  table.args = args;
+  args[0] = UCMD_PARG(E_ARG_STR, 'q');
+  TEST_ASSERT_EQUAL(E_INV_ARG, uCmd_InitPacked(&table));
+  args[0] = UCMD_PARG(E_ARG_U8, '`');
+  TEST_ASSERT_EQUAL(E_INV_ARG, uCmd_InitPacked(&table));
+  /* Names that do not fit in 5 bits are not remapped to a letter. */
+  args[0] = UCMD_PARG(E_ARG_U8, 'Q');
+  TEST_ASSERT_EQUAL(E_INV_ARG, uCmd_InitPacked(&table));
+  args[0] = UCMD_PARG(E_ARG_U8, '1');
+  TEST_ASSERT_EQUAL(E_INV_ARG, uCmd_InitPacked(&table));
+  args[0] = UCMD_PARG(E_ARG_U8, 'q');
+  args[2] = UCMD_PARG(E_ARG_U8, 'q');
+  TEST_ASSERT_EQUAL(E_INV_ARG, uCmd_InitPacked(&table));
+  TEST_ASSERT_EQUAL(E_NULL_PTR, uCmd_InitPacked(NULL));
+}
+#endif
+
+#if UCMD_FRAME
+/* Arguments of cmd_max_arg: q255 r-128 s2300 z-32000, little-endian. */
+static const uint8_t frame_max_args[] = {0xFF, 0x80, 0xFC, 0x08, 0x00, 0x00, 0x00, 0x83};
+
+static size_t helper_frame(uint8_t* buf, uint16_t cmd, const uint8_t* args, size_t args_sz) {
+  size_t frame_sz = 0;
+  TEST_ASSERT_EQUAL(E_OK, uCmdFrame_Encode(buf, UCMD_FRAME_MAX_SIZE, cmd, args, args_sz, &frame_sz));
+  return frame_sz;
+}
+
+static void helper_frame_feed(const uint8_t* buf, size_t frame_sz) {
+  size_t i;
+  for(i = 0; i < frame_sz; i++) {
+    uCmd_FrameByte(buf[i]);
+  }
+}
+
+void test_frame_commands(void) {
+  static const uint8_t one_arg[] = {12};
+  uint8_t buf[UCMD_FRAME_MAX_SIZE];
+  size_t frame_sz;
+  helper_setup();
+  memset((void*)&max_args_s, 0, sizeof(max_args_s));
+  frame_sz = helper_frame(buf, 3, frame_max_args, sizeof(frame_max_args));
+  TEST_ASSERT_EQUAL_UINT32(UCMD_FRAME_HEAD_SIZE + sizeof(frame_max_args) + UCMD_FRAME_CRC_SIZE, frame_sz);
+  TEST_ASSERT_EQUAL(E_OK, uCmd_RunFrame(buf, frame_sz));
+  TEST_ASSERT_EQUAL_UINT8(255, max_args_s.q);
+  TEST_ASSERT_EQUAL_INT8(-128, max_args_s.r);
+  TEST_ASSERT_EQUAL_INT32(2300, max_args_s.s);
+  TEST_ASSERT_EQUAL_INT16(-32000, max_args_s.z);
+
+  /* Leading arguments alone, the others are not given. */
+  TEST_ASSERT_EQUAL(E_OK, uCmd_RunFrame(buf, helper_frame(buf, 3, frame_max_args, 2)));
+  TEST_ASSERT_EQUAL_INT8(-128, max_args_s.r);
+  TEST_ASSERT_EQUAL_INT32(0, max_args_s.s);
+  cmd_one_arg_is_valid = 1;
+  TEST_ASSERT_EQUAL(E_OK, uCmd_RunFrame(buf, helper_frame(buf, 2, NULL, 0)));
+  TEST_ASSERT_FALSE(cmd_one_arg_is_valid);
+  TEST_ASSERT_EQUAL(E_OK, uCmd_RunFrame(buf, helper_frame(buf, 2, one_arg, 1)));
+  TEST_ASSERT_TRUE(cmd_one_arg_is_valid);
+  TEST_ASSERT_EQUAL_UINT8(12, cmd_one_arg_callback_is_called);
+  TEST_ASSERT_EQUAL(E_OK, uCmd_RunFrame(buf, helper_frame(buf, 0, NULL, 0)));
+  TEST_ASSERT_TRUE(simple_cmd_callback_is_called);
+
+  /* Arguments that stop within a value, or exceed the list. */
+  TEST_ASSERT_EQUAL(E_INV_SIZE, uCmd_RunFrame(buf, helper_frame(buf, 3, frame_max_args, 3)));
+  TEST_ASSERT_EQUAL(E_INV_SIZE, uCmd_RunFrame(buf, helper_frame(buf, 2, frame_max_args, 2)));
+  TEST_ASSERT_EQUAL(E_INTERNAL, uCmd_RunFrame(buf, helper_frame(buf, 4, NULL, 0)));
+  TEST_ASSERT_EQUAL(E_INTERNAL, uCmd_RunFrame(buf, helper_frame(buf, 0x0100, NULL, 0)));
+
+  /* Framing. */
+  frame_sz = helper_frame(buf, 2, one_arg, 1);
+  TEST_ASSERT_EQUAL(E_INV_SIZE, uCmd_RunFrame(buf, frame_sz - 1));
+  TEST_ASSERT_EQUAL(E_INV_SIZE, uCmd_RunFrame(buf, 3));
+  buf[frame_sz - 1] ^= 0x01;
+  TEST_ASSERT_EQUAL(E_INV_ARG, uCmd_RunFrame(buf, frame_sz));
+  frame_sz = helper_frame(buf, 2, one_arg, 1);
+  buf[0] = 0x5A;
+  TEST_ASSERT_EQUAL(E_INV_ARG, uCmd_RunFrame(buf, frame_sz));
+  TEST_ASSERT_EQUAL(E_NULL_PTR, uCmd_RunFrame(NULL, frame_sz));
+  TEST_ASSERT_EQUAL(E_INV_SIZE, uCmdFrame_Encode(buf, 6, 2, one_arg, 1, &frame_sz));
+}
+
+void test_frame_receiver(void) {
+  static const uint8_t sync_arg[] = {UCMD_FRAME_SYNC};
+  uint8_t buf[UCMD_FRAME_MAX_SIZE];
+  size_t frame_sz;
+  uint8_t val;
+  uint32_t i;
+  helper_setup();
+  cmd_one_arg_callback_is_called = 0;
+  /* Noise before a frame is skipped, a frame with a bad CRC is dropped. */
+  uCmd_FrameByte(0x00);
+  uCmd_FrameByte(0x11);
+  helper_frame_feed(buf, helper_frame(buf, 2, frame_max_args, 1));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_FrameLoop());
+  TEST_ASSERT_EQUAL_UINT8(255, cmd_one_arg_callback_is_called);
+  frame_sz = helper_frame(buf, 1, NULL, 0);
+  buf[frame_sz - 2] ^= 0x80;
+  helper_frame_feed(buf, frame_sz);
+  TEST_ASSERT_EQUAL_UINT16(1, uCmd_GetFrameErrCnt());
+  TEST_ASSERT_EQUAL(E_OK, uCmd_FrameLoop());
+  TEST_ASSERT_FALSE(cmd_no_args_callback_is_called);
+  helper_frame_feed(buf, helper_frame(buf, 1, NULL, 0));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_FrameLoop());
+  TEST_ASSERT_TRUE(cmd_no_args_callback_is_called);
+
+  /* A frame that arrives while the queue is full is dropped whole, sync
+     bytes in its arguments included. */
+  for(i = 0; i < UCMD_FRAME_QUEUE_DEPTH; i++) {
+    val = (uint8_t)i;
+    helper_frame_feed(buf, helper_frame(buf, 2, &val, 1));
+  }
+  helper_frame_feed(buf, helper_frame(buf, 2, sync_arg, 1));
+  TEST_ASSERT_EQUAL_UINT16(1, uCmd_GetFrameDropCnt());
+  for(i = 0; i < UCMD_FRAME_QUEUE_DEPTH; i++) {
+    TEST_ASSERT_EQUAL(E_OK, uCmd_FrameLoop());
+    TEST_ASSERT_EQUAL_UINT8(i, cmd_one_arg_callback_is_called);
+  }
+  helper_frame_feed(buf, helper_frame(buf, 2, sync_arg, 1));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_FrameLoop());
+  TEST_ASSERT_EQUAL_UINT8(UCMD_FRAME_SYNC, cmd_one_arg_callback_is_called);
+  TEST_ASSERT_EQUAL_UINT16(1, uCmd_GetFrameErrCnt());
+}
+
+void test_frame_bound_arguments(void) {
+  const uCmdInfo_s bound_a[] = {
+    {"cmd_bound", cmd_bound_callback, {
+      UCMD_ARG_BIND(E_ARG_U8, 'q', struct MaxArgs, q),
+      UCMD_ARG_BIND(E_ARG_I8, 'r', struct MaxArgs, r),
+      UCMD_ARG_BIND(E_ARG_I32, 's', struct MaxArgs, s),
+      UCMD_ARG_BIND(E_ARG_I16, 'z', struct MaxArgs, z)}, &bound_args_s},
+    {"cmd_no_struct", cmd_bound_callback, {
+      UCMD_ARG_BIND(E_ARG_U8, 'q', struct MaxArgs, q)}, UCMD_ARG_USER_NONE},
+  };
+  uCmdCtx_s ctx;
+  uint8_t buf[UCMD_FRAME_MAX_SIZE];
+  memset((void*)&bound_args_s, 0, sizeof(bound_args_s));
+  TEST_ASSERT_EQUAL(E_OK, uCmdCtx_InitTable(&ctx, bound_a, UCMD_GET_TABLE_SIZE(bound_a)));
+  TEST_ASSERT_EQUAL(E_OK, uCmdCtx_RunFrame(&ctx, buf, helper_frame(buf, 0, frame_max_args, sizeof(frame_max_args))));
+  TEST_ASSERT_EQUAL_UINT8(255, bound_args_s.q);
+  TEST_ASSERT_EQUAL_INT8(-128, bound_args_s.r);
+  TEST_ASSERT_EQUAL_INT32(2300, bound_args_s.s);
+  TEST_ASSERT_EQUAL_INT16(-32000, bound_args_s.z);
+  /* Nothing is stored from a frame that fails. */
+  TEST_ASSERT_EQUAL(E_INV_SIZE, uCmdCtx_RunFrame(&ctx, buf, helper_frame(buf, 0, frame_max_args, 3)));
+  TEST_ASSERT_EQUAL_UINT8(255, bound_args_s.q);
+  TEST_ASSERT_EQUAL(E_NULL_PTR, uCmdCtx_RunFrame(&ctx, buf, helper_frame(buf, 1, frame_max_args, 1)));
+}
+#endif
+
+#if UCMD_STATS || UCMD_TRACE
+/* Everything queued on the default Tx instance, as a string. */
+static const char* helper_tx_str(void) {
+  static char str[TX_BUFF_SIZE + 1];
+  size_t len = 0;
+  uint8_t byte;
+  while(Tx_GetByte(&byte)) {
+    str[len++] = (char)byte;
+  }
+  str[len] = '\0';
+  return str;
+}
+#endif
+
+#if UCMD_STATS
+static const uCmdInfo_s stats_info_a[] = {
+  {"a", simple_cmd_callback, UCMD_ARG_NONE, UCMD_ARG_USER_NONE},
+  {"cmd_one_arg", cmd_one_arg_callback, {UCMD_ARG_DESC(E_ARG_U8, 'q')}, UCMD_ARG_USER_NONE},
+  UCMD_STATS_CMD(NULL),
+};
+
+static uCmdStats_s stats_s;
+static uint32_t stats_ticks;
+
+/* Each reading is 5 ticks after the previous one. */
+static uint32_t helper_stats_clock(void) {
+  stats_ticks += 5;
+  return stats_ticks;
+}
+
+void test_stats_counts(void) {
+  static uCmdCtx_s ctx;
+  const uCmdStatsCmd_s* cmd;
+  uCmdStatsCmd_s prev;
+  TEST_ASSERT_EQUAL(E_NOT_INITIALIZED, uCmdCtx_SetStats(&ctx, &stats_s));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_InitTable(stats_info_a, UCMD_GET_TABLE_SIZE(stats_info_a)));
+  uCmdStats_Init(&stats_s);
+  TEST_ASSERT_EQUAL(E_OK, uCmd_SetStats(&stats_s));
+  uCmd_SetClock(helper_stats_clock);
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("a"));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("cmd_one_arg q7"));
+  TEST_ASSERT_EQUAL(E_OUT_OF_RANGE, uCmd_Run("cmd_one_arg q300"));
+  TEST_ASSERT_EQUAL(E_INTERNAL, uCmd_Run("nope"));
+
+  /* Each stage took 5 ticks, 3 significant bits. */
+  cmd = uCmdStats_GetCmd(&stats_s, 0);
+  TEST_ASSERT_EQUAL_UINT32(1, cmd->runs);
+  TEST_ASSERT_EQUAL_UINT32(1, cmd->rets[E_OK]);
+  TEST_ASSERT_EQUAL_UINT32(1, cmd->parse[3]);
+  TEST_ASSERT_EQUAL_UINT32(1, cmd->call[3]);
+  /* A line that fails in its arguments is counted against its command. */
+  cmd = uCmdStats_GetCmd(&stats_s, 1);
+  TEST_ASSERT_EQUAL_UINT32(1, cmd->runs);
+  TEST_ASSERT_EQUAL_UINT32(1, cmd->rets[E_OK]);
+  TEST_ASSERT_EQUAL_UINT32(1, cmd->rets[E_OUT_OF_RANGE]);
+  TEST_ASSERT_EQUAL_UINT32(2, cmd->parse[3]);
+  TEST_ASSERT_EQUAL_UINT32(1, cmd->call[3]);
+  cmd = uCmdStats_GetCmd(&stats_s, UCMD_STATS_UNKNOWN + 10);
+  TEST_ASSERT_EQUAL_UINT32(0, cmd->runs);
+  TEST_ASSERT_EQUAL_UINT32(1, cmd->rets[E_INTERNAL]);
+
+#if UCMD_STREAM
+  /* Streamed lines are counted, without parse time. */
+  helper_stream("a");
+  TEST_ASSERT_EQUAL(E_OK, uCmd_StreamLoop());
+  helper_stream("zz");
+  TEST_ASSERT_EQUAL(E_INTERNAL, uCmd_StreamLoop());
+  TEST_ASSERT_EQUAL_UINT32(2, uCmdStats_GetCmd(&stats_s, 0)->runs);
+  TEST_ASSERT_EQUAL_UINT32(1, uCmdStats_GetCmd(&stats_s, 0)->parse[3]);
+  TEST_ASSERT_EQUAL_UINT32(2, uCmdStats_GetCmd(&stats_s, 0)->call[3]);
+  TEST_ASSERT_EQUAL_UINT32(2, uCmdStats_GetCmd(&stats_s, UCMD_STATS_UNKNOWN)->rets[E_INTERNAL]);
+#endif
+#if UCMD_FRAME
+  {
+    uint8_t buf[UCMD_FRAME_MAX_SIZE];
+    TEST_ASSERT_EQUAL(E_OK, uCmd_RunFrame(buf, helper_frame(buf, 1, NULL, 0)));
+    TEST_ASSERT_EQUAL(E_INTERNAL, uCmd_RunFrame(buf, helper_frame(buf, 7, NULL, 0)));
+    TEST_ASSERT_EQUAL_UINT32(2, uCmdStats_GetCmd(&stats_s, 1)->runs);
+    TEST_ASSERT_EQUAL_UINT32(3, uCmdStats_GetCmd(&stats_s, 1)->parse[3]);
+  }
+#endif
+
+  /* Without clock only counts are kept. */
+  uCmd_SetClock(NULL);
+  memcpy(&prev, uCmdStats_GetCmd(&stats_s, 1), sizeof(prev));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("cmd_one_arg"));
+  cmd = uCmdStats_GetCmd(&stats_s, 1);
+  TEST_ASSERT_EQUAL_UINT32(prev.runs + 1, cmd->runs);
+  TEST_ASSERT_EQUAL_MEMORY(prev.call, cmd->call, sizeof(prev.call));
+
+  /* Installing a table detaches the counters. */
+  memcpy(&prev, uCmdStats_GetCmd(&stats_s, 0), sizeof(prev));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_InitTable(stats_info_a, UCMD_GET_TABLE_SIZE(stats_info_a)));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("a"));
+  TEST_ASSERT_EQUAL_UINT32(prev.runs, uCmdStats_GetCmd(&stats_s, 0)->runs);
+  TEST_ASSERT_EQUAL(E_NOT_INITIALIZED, uCmd_Run("stats"));
+}
+
+void test_stats_command(void) {
+  TEST_ASSERT_EQUAL(E_OK, uCmd_InitTable(stats_info_a, UCMD_GET_TABLE_SIZE(stats_info_a)));
+  uCmdStats_Init(&stats_s);
+  TEST_ASSERT_EQUAL(E_OK, uCmd_SetStats(&stats_s));
+  uCmd_SetClock(NULL);
+  Tx_Init();
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("a"));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("a"));
+  TEST_ASSERT_EQUAL(E_OUT_OF_RANGE, uCmd_Run("cmd_one_arg q300"));
+  TEST_ASSERT_EQUAL(E_INTERNAL, uCmd_Run("zz"));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run(UCMD_STATS_NAME));
+  TEST_ASSERT_EQUAL_STRING("a runs=2 errs=0\n\r"
+                           "cmd_one_arg runs=0 errs=1\n\r"
+                           "? runs=0 errs=1\n\r", helper_tx_str());
+
+  uCmd_SetClock(helper_stats_clock);
+  stats_ticks = 0;
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("cmd_one_arg q1"));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("stats c1"));
+  TEST_ASSERT_EQUAL_STRING("cmd_one_arg runs=1 errs=1\n\r"
+                           " ret 0=1 6=1\n\r"
+                           " parse 3=1\n\r"
+                           " call 3=1\n\r", helper_tx_str());
+  /* Indexes past the table give the names not found. */
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("stats c9"));
+  TEST_ASSERT_EQUAL_STRING("? runs=0 errs=1\n\r"
+                           " ret 9=1\n\r"
+                           " parse\n\r"
+                           " call\n\r", helper_tx_str());
+  /* The stats command counts itself. */
+  TEST_ASSERT_EQUAL_UINT32(3, uCmdStats_GetCmd(&stats_s, 2)->runs);
+
+  /* A report that does not fit is cut and reported. */
+  Tx_Write(helper_tx_str(), TX_BUFF_SIZE - 8);
+  TEST_ASSERT_EQUAL(E_TOO_LARGE, uCmd_Run("stats"));
+  Tx_Init();
+  uCmd_SetClock(NULL);
+}
+#endif
+
+#if UCMD_LATENCY
+static uint32_t latency_ticks;
+
+static uint32_t helper_latency_clock(void) {
+  return latency_ticks;
+}
+
+void test_queueing_latency(void) {
+  uCmdLatency_s lat;
+  helper_setup();
+  TEST_ASSERT_EQUAL(E_OK, uCmd_GetLatency(&lat));
+  TEST_ASSERT_EQUAL_UINT32(0, lat.cnt);
+  TEST_ASSERT_EQUAL_UINT32(0, lat.min);
+  uCmd_SetClock(helper_latency_clock);
+  /* The second line waits for the first one. */
+  latency_ticks = 100;
+  helper_fill_buff("a");
+  latency_ticks = 130;
+  helper_fill_buff("cmd_no_args");
+  latency_ticks = 200;
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Loop());
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Loop());
+  /* Lines that fail, and lines run without the Line queue, are not measured. */
+  helper_fill_buff("nope");
+  TEST_ASSERT_EQUAL(E_INTERNAL, uCmd_Loop());
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("a"));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_GetLatency(&lat));
+  TEST_ASSERT_EQUAL_UINT32(2, lat.cnt);
+  TEST_ASSERT_EQUAL_UINT32(70, lat.min);
+  TEST_ASSERT_EQUAL_UINT32(100, lat.max);
+  TEST_ASSERT_EQUAL_UINT32(85, lat.mean);
+  /* The clock may wrap around between both ends. */
+  latency_ticks = UINT32_MAX - 9;
+  helper_fill_buff("a");
+  latency_ticks = 20;
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Loop());
+  TEST_ASSERT_EQUAL(E_OK, uCmd_GetLatency(&lat));
+  TEST_ASSERT_EQUAL_UINT32(3, lat.cnt);
+  TEST_ASSERT_EQUAL_UINT32(30, lat.min);
+  TEST_ASSERT_EQUAL_UINT32(66, lat.mean);
+
+  uCmd_ResetLatency();
+  TEST_ASSERT_EQUAL(E_OK, uCmd_GetLatency(&lat));
+  TEST_ASSERT_EQUAL_UINT32(0, lat.cnt);
+  TEST_ASSERT_EQUAL_UINT32(0, lat.max);
+  TEST_ASSERT_EQUAL(E_NULL_PTR, uCmd_GetLatency(NULL));
+  uCmd_SetClock(NULL);
+}
+#endif
+
+#if UCMD_TRACE
+static const uCmdInfo_s trace_info_a[] = {
+  {"a", simple_cmd_callback, UCMD_ARG_NONE, UCMD_ARG_USER_NONE},
+  {"cmd_one_arg", cmd_one_arg_callback, {UCMD_ARG_DESC(E_ARG_U8, 'q')}, UCMD_ARG_USER_NONE},
+  {"cmd_max_arg", cmd_max_arg_callback, {UCMD_ARG_DESC(E_ARG_U8, 'q'), UCMD_ARG_DESC(E_ARG_I8, 'r'), UCMD_ARG_DESC(E_ARG_I32, 's'), UCMD_ARG_DESC(E_ARG_I16, 'z')},
+   UCMD_ARG_USER_NONE},
+  UCMD_TRACE_CMD(NULL),
+};
+
+static uCmdTrace_s trace_s;
+static uint32_t trace_ticks;
+
+static uint32_t helper_trace_clock(void) {
+  return trace_ticks;
+}
+
+void test_trace_records(void) {
+  static uCmdCtx_s ctx;
+  const uCmdTraceRec_s* rec;
+  int16_t z = 0;
+  size_t i;
+  TEST_ASSERT_EQUAL(E_NOT_INITIALIZED, uCmdCtx_SetTrace(&ctx, &trace_s));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_InitTable(trace_info_a, UCMD_GET_TABLE_SIZE(trace_info_a)));
+  uCmdTrace_Init(&trace_s);
+  TEST_ASSERT_EQUAL(E_OK, uCmd_SetTrace(&trace_s));
+  TEST_ASSERT_NULL(uCmdTrace_Get(&trace_s, 0));
+  uCmd_SetClock(helper_trace_clock);
+  trace_ticks = 10;
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("a"));
+  trace_ticks = 20;
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("cmd_one_arg q7"));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("cmd_max_arg q1 z-2"));
+  TEST_ASSERT_EQUAL(E_OUT_OF_RANGE, uCmd_Run("cmd_one_arg q300"));
+  TEST_ASSERT_EQUAL(E_INTERNAL, uCmd_Run("nope"));
+
+  rec = uCmdTrace_Get(&trace_s, 4);
+  TEST_ASSERT_EQUAL_UINT32(10, rec->time);
+  TEST_ASSERT_EQUAL_UINT16(0, rec->cmd);
+  TEST_ASSERT_EQUAL_UINT8(E_OK, rec->ret);
+  TEST_ASSERT_EQUAL_HEX8(0, rec->valid);
+  rec = uCmdTrace_Get(&trace_s, 3);
+  TEST_ASSERT_EQUAL_UINT32(20, rec->time);
+  TEST_ASSERT_EQUAL_UINT16(1, rec->cmd);
+  TEST_ASSERT_EQUAL_HEX8(0x01, rec->valid);
+  TEST_ASSERT_EQUAL_UINT8(7, rec->args[0][0]);
+  rec = uCmdTrace_Get(&trace_s, 2);
+  TEST_ASSERT_EQUAL_UINT16(2, rec->cmd);
+  TEST_ASSERT_EQUAL_HEX8(0x09, rec->valid);
+  memcpy(&z, rec->args[3], sizeof(z));
+  TEST_ASSERT_EQUAL_INT16(-2, z);
+  /* Lines that fail keep no argument. */
+  rec = uCmdTrace_Get(&trace_s, 1);
+  TEST_ASSERT_EQUAL_UINT16(1, rec->cmd);
+  TEST_ASSERT_EQUAL_UINT8(E_OUT_OF_RANGE, rec->ret);
+  TEST_ASSERT_EQUAL_HEX8(0, rec->valid);
+  rec = uCmdTrace_Get(&trace_s, 0);
+  TEST_ASSERT_EQUAL_UINT16(UCMD_TRACE_UNKNOWN, rec->cmd);
+  TEST_ASSERT_EQUAL_UINT8(E_INTERNAL, rec->ret);
+
+#if UCMD_STREAM
+  helper_stream("cmd_one_arg q9");
+  TEST_ASSERT_EQUAL(E_OK, uCmd_StreamLoop());
+  TEST_ASSERT_EQUAL_UINT16(1, uCmdTrace_Get(&trace_s, 0)->cmd);
+  TEST_ASSERT_EQUAL_UINT8(9, uCmdTrace_Get(&trace_s, 0)->args[0][0]);
+#endif
+#if UCMD_FRAME
+  {
+    static const uint8_t one_arg[] = {11};
+    uint8_t buf[UCMD_FRAME_MAX_SIZE];
+    TEST_ASSERT_EQUAL(E_OK, uCmd_RunFrame(buf, helper_frame(buf, 1, one_arg, 1)));
+    TEST_ASSERT_EQUAL_UINT8(11, uCmdTrace_Get(&trace_s, 0)->args[0][0]);
+    TEST_ASSERT_EQUAL(E_INTERNAL, uCmd_RunFrame(buf, helper_frame(buf, 9, NULL, 0)));
+    TEST_ASSERT_EQUAL_UINT16(UCMD_TRACE_UNKNOWN, uCmdTrace_Get(&trace_s, 0)->cmd);
+  }
+#endif
+
+  /* The oldest records are overwritten. */
+  for(i = 0; i < UCMD_TRACE_DEPTH; i++) {
+    TEST_ASSERT_EQUAL(E_OK, uCmd_Run("a"));
+  }
+  TEST_ASSERT_NOT_NULL(uCmdTrace_Get(&trace_s, UCMD_TRACE_DEPTH - 1));
+  TEST_ASSERT_NULL(uCmdTrace_Get(&trace_s, UCMD_TRACE_DEPTH));
+  TEST_ASSERT_EQUAL_UINT16(0, uCmdTrace_Get(&trace_s, UCMD_TRACE_DEPTH - 1)->cmd);
+  /* Installing a table detaches the trace. */
+  TEST_ASSERT_EQUAL(E_OK, uCmd_InitTable(trace_info_a, UCMD_GET_TABLE_SIZE(trace_info_a)));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("a"));
+  TEST_ASSERT_EQUAL_UINT32(5 + UCMD_STREAM + 2 * UCMD_FRAME + UCMD_TRACE_DEPTH, trace_s.cnt);
+  uCmd_SetClock(NULL);
+}
+
+/* Nested commands are dumped with their path from the instance table. */
+void test_trace_nested_commands(void) {
+  const uCmdInfo_s motor_a[] = {
+    UCMD_SUBTABLE("1", &motor1_ctx),
+  };
+  helper_nested_setup();
+  uCmdTrace_Init(&trace_s);
+  TEST_ASSERT_EQUAL(E_OK, uCmd_SetTrace(&trace_s));
+  Tx_Init();
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("motor 1 pwm f2000"));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("motor 2 pwm f300"));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("a"));
+  TEST_ASSERT_EQUAL(E_INTERNAL, uCmd_Run("motor 1 nope"));
+  TEST_ASSERT_EQUAL_PTR(&motor1_ctx.table, uCmdTrace_Get(&trace_s, 0)->table);
+  TEST_ASSERT_EQUAL_UINT16(UCMD_TRACE_UNKNOWN, uCmdTrace_Get(&trace_s, 0)->cmd);
+  TEST_ASSERT_EQUAL_PTR(&motor2_ctx.table, uCmdTrace_Get(&trace_s, 2)->table);
+  TEST_ASSERT_EQUAL_UINT16(0, uCmdTrace_Get(&trace_s, 2)->cmd);
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Trace(NULL, NULL));
+  TEST_ASSERT_EQUAL_STRING("t=0 c=1.0.0 r=0 0=7D0\n\r"
+                           "t=0 c=1.1.0 r=0 0=12C\n\r"
+                           "t=0 c=0 r=0\n\r"
+                           "t=0 c=1.0.65535 r=9\n\r", helper_tx_str());
+#if UCMD_STREAM
+  helper_stream("motor 1 stop");
+  TEST_ASSERT_EQUAL(E_OK, uCmd_StreamLoop());
+  TEST_ASSERT_EQUAL_PTR(&motor1_ctx.table, uCmdTrace_Get(&trace_s, 0)->table);
+  TEST_ASSERT_EQUAL_UINT16(1, uCmdTrace_Get(&trace_s, 0)->cmd);
+  helper_stream("motor 2 nope");
+  TEST_ASSERT_EQUAL(E_INTERNAL, uCmd_StreamLoop());
+  TEST_ASSERT_EQUAL_PTR(&motor2_ctx.table, uCmdTrace_Get(&trace_s, 0)->table);
+  TEST_ASSERT_EQUAL_UINT16(UCMD_TRACE_UNKNOWN, uCmdTrace_Get(&trace_s, 0)->cmd);
+#endif
+  /* Records of a table no longer reached keep their own index. */
+  uCmdTrace_Init(&trace_s);
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("motor 2 pwm f1"));
+  TEST_ASSERT_EQUAL(E_OK, uCmdCtx_InitTable(&motor_ctx, motor_a, UCMD_GET_TABLE_SIZE(motor_a)));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Trace(NULL, NULL));
+  TEST_ASSERT_EQUAL_STRING("t=0 c=?.0 r=0 0=1\n\r", helper_tx_str());
+  uCmd_SetTrace(NULL);
+}
+
+void test_trace_command(void) {
+  TEST_ASSERT_EQUAL(E_OK, uCmd_InitTable(trace_info_a, UCMD_GET_TABLE_SIZE(trace_info_a)));
+  TEST_ASSERT_EQUAL(E_NOT_INITIALIZED, uCmd_Run(UCMD_TRACE_NAME));
+  uCmdTrace_Init(&trace_s);
+  TEST_ASSERT_EQUAL(E_OK, uCmd_SetTrace(&trace_s));
+  uCmd_SetClock(helper_trace_clock);
+  Tx_Init();
+  trace_ticks = 5;
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run("cmd_max_arg q1 z-2"));
+  trace_ticks = 70000;
+  TEST_ASSERT_EQUAL(E_INTERNAL, uCmd_Run("nope"));
+  TEST_ASSERT_EQUAL(E_OK, uCmd_Run(UCMD_TRACE_NAME));
+  TEST_ASSERT_EQUAL_STRING("t=5 c=2 r=0 0=1 3=FFFE\n\r"
+                           "t=70000 c=65535 r=9\n\r", helper_tx_str());
+  /* The dump is recorded as well. */
+  TEST_ASSERT_EQUAL_UINT16(3, uCmdTrace_Get(&trace_s, 0)->cmd);
+
+  /* A record that does not fit is dropped and reported. */
+  Tx_Write(helper_tx_str(), TX_BUFF_SIZE - 8);
+  TEST_ASSERT_EQUAL(E_TOO_LARGE, uCmd_Run(UCMD_TRACE_NAME));
+  Tx_Init();
+  uCmd_SetTrace(NULL);
+  uCmd_SetClock(NULL);
+}
+#endif
+
 void test_integration_all_tests(void) {
   RUN_TEST(test_single_char_command);
   RUN_TEST(test_multiple_char_command_no_arguments);
   RUN_TEST(test_char_command_one_argument);
   RUN_TEST(test_char_command_max_arguments);
   RUN_TEST(test_char_command_max_diff_positions);
+  RUN_TEST(test_out_of_range_argument);
+  RUN_TEST(test_bound_arguments);
+  RUN_TEST(test_invalid_table_is_rejected);
+  RUN_TEST(test_pipelined_commands);
+  RUN_TEST(test_independent_channels);
+  RUN_TEST(test_channels_in_threads);
+  RUN_TEST(test_nested_tables);
+#if UCMD_STREAM
+  RUN_TEST(test_stream_nested_tables);
+#endif
+#if UCMD_REGISTRY
+  RUN_TEST(test_registered_commands);
+#endif
+#if UCMD_FRAME
+  RUN_TEST(test_frame_commands);
+  RUN_TEST(test_frame_receiver);
+  RUN_TEST(test_frame_bound_arguments);
+#endif
+#if UCMD_STREAM
+  RUN_TEST(test_stream_matches_run);
+  RUN_TEST(test_stream_pipelined_commands);
+  RUN_TEST(test_stream_bound_arguments);
+  RUN_TEST(test_stream_oversized_table);
+#endif
+#if UCMD_PACKED
+  RUN_TEST(test_packed_matches_table);
+  RUN_TEST(test_packed_table);
+#endif
+#if UCMD_STATS
+  RUN_TEST(test_stats_counts);
+  RUN_TEST(test_stats_command);
+#endif
+#if UCMD_LATENCY
+  RUN_TEST(test_queueing_latency);
+#endif
+#if UCMD_TRACE
+  RUN_TEST(test_trace_records);
+  RUN_TEST(test_trace_nested_commands);
+  RUN_TEST(test_trace_command);
+#endif
 }
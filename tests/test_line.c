@@ -1,6 +1,9 @@
 #include "unity.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include "line.h"
 
 /*-----------------------------------------------------------------------------
@@ -81,9 +84,10 @@ void test_Line_BufferIsFull_flag(void) {
   uint8_t idx = 0;
   Line_Init();
   for(; idx < LINE_BUFF_SIZE - 1; idx++) {
-    test_buff[idx] = idx;
+    /* Stay clear of CR and LF, which would complete and queue the line early. */
+    test_buff[idx] = LINE_CHAR_0 + (idx % 10);
     TEST_ASSERT_FALSE(Line_BuffIsFull());
-    Line_AddChar(idx);
+    Line_AddChar(test_buff[idx]);
   }
   /* Last character must be EOL char or buffer will automatically flush. */
   Line_AddChar(LINE_CHAR_LF);
@@ -135,6 +139,26 @@ void test_Line_FlushBuff(void) {
   TEST_ASSERT_EQUAL_UINT8(0, Line_GetCnt());
 }
 
+/* Flushing is done by the consumer, the receiver keeps its line. */
+void test_Line_FlushBuff_keeps_line_in_reception(void) {
+  Line_Init();
+  helper_line_add_string("ab\nxy\ncd", 8);
+  TEST_ASSERT_EQUAL_UINT8(2, Line_GetQueueCnt());
+  Line_FlushBuff();
+  TEST_ASSERT_EQUAL_UINT8(0, Line_GetQueueCnt());
+  TEST_ASSERT_FALSE(Line_IsCmplt());
+  helper_line_add_string("e\n", 2);
+  TEST_ASSERT_EQUAL_STRING("cde", Line_AcquireBuff());
+  Line_ReleaseBuff();
+  /* Released slots are reused clean. */
+  helper_line_add_string("f\ng\nh\n", 6);
+  TEST_ASSERT_EQUAL_STRING("f", Line_AcquireBuff());
+  Line_ReleaseBuff();
+  TEST_ASSERT_EQUAL_STRING("g", Line_AcquireBuff());
+  Line_ReleaseBuff();
+  TEST_ASSERT_EQUAL_STRING("h", Line_AcquireBuff());
+}
+
 void test_Line_IsCmplt(void) {
   Line_Init();
   TEST_ASSERT_TRUE(Line_BuffIsEmpty());
@@ -170,25 +194,46 @@ void test_Line_IsCmplt(void) {
 }
 
 void test_Line_longest_command_wo_oveflow(void) {
+  uint16_t idx;
   Line_Init();
   /* Longest possible correct raw (fits in buffer) command. */
   helper_line_add_string("pppppppppppppppppppppppppppppppppppppppppppppppppppppppppppp    \n", LINE_BUFF_SIZE);
   TEST_ASSERT_TRUE(Line_BuffIsFull());
   TEST_ASSERT_FALSE(Line_BuffIsOvrFlwn());
   TEST_ASSERT_TRUE(Line_IsCmplt());
-  /* Longest possible correct command. */
-  helper_line_add_string("abdlkslfkdlqksu\r", LINE_BUFF_SIZE);
+  /* Longest possible correct command, read once the previous line is done. */
+  Line_ReleaseBuff();
+  for(idx = 0; idx < LINE_MAX_STR_LEN; idx++) {
+    Line_AddChar((char)(LINE_CHAR_a + (idx % 26)));
+  }
+  Line_AddChar(LINE_CHAR_CR);
   TEST_ASSERT_TRUE(Line_BuffIsFull());
   TEST_ASSERT_FALSE(Line_BuffIsOvrFlwn());
   TEST_ASSERT_TRUE(Line_IsCmplt());
-  /* Incorrect command. */
+  TEST_ASSERT_EQUAL_UINT16(LINE_BUFF_SIZE, Line_GetCnt());
+  /* Incorrect command, one character longer. */
   Line_FlushBuff();
-  helper_line_add_string("abdlkslfkdlqksuz", LINE_BUFF_SIZE);
+  for(idx = 0; idx < LINE_BUFF_SIZE; idx++) {
+    Line_AddChar('z');
+  }
   TEST_ASSERT_TRUE(Line_BuffIsEmpty());
   TEST_ASSERT_TRUE(Line_BuffIsOvrFlwn());
   TEST_ASSERT_FALSE(Line_IsCmplt());
 }
 
+/* Buffer flags and count are those of the oldest line in the queue. */
+void test_Line_BuffIsFull_reports_oldest_line(void) {
+  Line_Init();
+  helper_line_fill_buff('p');
+  helper_line_add_string("ab\r", 3);
+  TEST_ASSERT_EQUAL_UINT8(2, Line_GetQueueCnt());
+  TEST_ASSERT_TRUE(Line_BuffIsFull());
+  TEST_ASSERT_EQUAL_UINT16(LINE_BUFF_SIZE, Line_GetCnt());
+  Line_ReleaseBuff();
+  TEST_ASSERT_FALSE(Line_BuffIsFull());
+  TEST_ASSERT_EQUAL_UINT16(3, Line_GetCnt());
+}
+
 void test_Line_buffer_overflow_behavior(void) {
   uint8_t idx;
   Line_Init();
@@ -220,13 +265,327 @@ void test_Line_buffer_overflow_behavior(void) {
   TEST_ASSERT_EQUAL_UINT8(2, Line_GetCnt());
 }
 
+void test_Line_queue_keeps_lines_in_order(void) {
+  uint8_t idx;
+  char line[] = "cmd0\n";
+  Line_Init();
+  /* Fill every slot of the queue without consuming any line. */
+  for(idx = 0; idx < LINE_QUEUE_DEPTH; idx++) {
+    line[3] = '0' + idx;
+    helper_line_add_string(line, sizeof(line) - 1);
+    TEST_ASSERT_TRUE(Line_IsCmplt());
+    TEST_ASSERT_EQUAL_UINT8(idx + 1, Line_GetQueueCnt());
+  }
+  TEST_ASSERT_EQUAL_UINT16(0, Line_GetDropCnt());
+  /* The oldest line is reported until it is popped. */
+  Line_GetBuff(test_buff);
+  TEST_ASSERT_EQUAL_STRING("cmd0", test_buff);
+  for(idx = 0; idx < LINE_QUEUE_DEPTH; idx++) {
+    line[3] = '0' + idx;
+    line[4] = '\0';
+    Line_PopBuff(test_buff);
+    TEST_ASSERT_EQUAL_STRING(line, test_buff);
+    TEST_ASSERT_EQUAL_UINT8(LINE_QUEUE_DEPTH - idx - 1, Line_GetQueueCnt());
+  }
+  TEST_ASSERT_FALSE(Line_IsCmplt());
+  TEST_ASSERT_TRUE(Line_BuffIsEmpty());
+  /* Popping an empty queue leaves the target buffer untouched. */
+  memset((void*)test_buff, 'x', sizeof(test_buff));
+  Line_PopBuff(test_buff);
+  TEST_ASSERT_EACH_EQUAL_UINT8('x', test_buff, sizeof(test_buff));
+}
+
+void test_Line_queue_full_drops_lines(void) {
+  uint8_t idx;
+  Line_Init();
+  for(idx = 0; idx < LINE_QUEUE_DEPTH; idx++) {
+    helper_line_add_string("keep\r", 5);
+  }
+  /* No slot is left, whole lines are dropped and counted once each. */
+  helper_line_add_string("lost\r", 5);
+  helper_line_add_string("\r\n lost again\n", 14);
+  TEST_ASSERT_EQUAL_UINT16(2, Line_GetDropCnt());
+  TEST_ASSERT_EQUAL_UINT8(LINE_QUEUE_DEPTH, Line_GetQueueCnt());
+  /* A line that started while the queue was full is dropped up to its end, */
+  /* even if a slot is released meanwhile. */
+  helper_line_add_string("par", 3);
+  Line_PopBuff(test_buff);
+  TEST_ASSERT_EQUAL_STRING("keep", test_buff);
+  helper_line_add_string("tial\n", 5);
+  TEST_ASSERT_EQUAL_UINT16(3, Line_GetDropCnt());
+  TEST_ASSERT_EQUAL_UINT8(LINE_QUEUE_DEPTH - 1, Line_GetQueueCnt());
+  /* The next line fits in the released slot. */
+  helper_line_add_string("next\n", 5);
+  TEST_ASSERT_EQUAL_UINT8(LINE_QUEUE_DEPTH, Line_GetQueueCnt());
+  TEST_ASSERT_EQUAL_UINT16(3, Line_GetDropCnt());
+  for(idx = 0; idx < LINE_QUEUE_DEPTH; idx++) {
+    Line_PopBuff(test_buff);
+  }
+  TEST_ASSERT_EQUAL_STRING("next", test_buff);
+  /* Flushing discards every queued line. */
+  helper_line_add_string("a\nb\n", 4);
+  Line_FlushBuff();
+  TEST_ASSERT_EQUAL_UINT8(0, Line_GetQueueCnt());
+  TEST_ASSERT_TRUE(Line_BuffIsEmpty());
+}
+
+void test_Line_acquire_release_in_place(void) {
+  const uint8_t* line;
+  Line_Init();
+  TEST_ASSERT_NULL(Line_AcquireBuff());
+  helper_line_add_string("ping\n", 5);
+  line = Line_AcquireBuff();
+  TEST_ASSERT_NOT_NULL(line);
+  TEST_ASSERT_EQUAL_STRING("ping", line);
+  /* While the consumer works on the line in place, the next one is received */
+  /* into another slot and does not disturb it. */
+  helper_line_add_string("pong\n", 5);
+  TEST_ASSERT_EQUAL_STRING("ping", line);
+  TEST_ASSERT_TRUE(Line_AcquireBuff() == line);
+  TEST_ASSERT_EQUAL_UINT8(2, Line_GetQueueCnt());
+  Line_ReleaseBuff();
+  TEST_ASSERT_EQUAL_UINT8(1, Line_GetQueueCnt());
+  line = Line_AcquireBuff();
+  TEST_ASSERT_EQUAL_STRING("pong", line);
+  Line_ReleaseBuff();
+  TEST_ASSERT_NULL(Line_AcquireBuff());
+  /* Releasing with nothing acquired has no effect. */
+  Line_ReleaseBuff();
+  TEST_ASSERT_EQUAL_UINT8(0, Line_GetQueueCnt());
+  helper_line_add_string("x\n", 2);
+  TEST_ASSERT_EQUAL_STRING("x", Line_AcquireBuff());
+}
+
+void helper_count_callback(void* arg) {
+  (*(uint8_t*)arg)++;
+}
+
+void test_Line_event_callbacks(void) {
+  uint8_t cmplt = 0;
+  uint8_t ovrflw = 0;
+  uint8_t idx;
+  Line_Init();
+  Line_SetCmpltCallback(helper_count_callback, &cmplt);
+  Line_SetOvrFlwCallback(helper_count_callback, &ovrflw);
+  helper_line_add_string("a\r\n", 3);
+  TEST_ASSERT_EQUAL_UINT8(1, cmplt);
+  Line_AddChars((const uint8_t*)"bb\ncc\n\n", 7);
+  TEST_ASSERT_EQUAL_UINT8(3, cmplt);
+  TEST_ASSERT_EQUAL_UINT8(0, ovrflw);
+  for(idx = 0; idx < LINE_BUFF_SIZE; idx++) {
+    Line_AddChar('o');
+  }
+  TEST_ASSERT_EQUAL_UINT8(1, ovrflw);
+  /* Recovering from the overflow does not complete a line. */
+  Line_AddChar('\n');
+  TEST_ASSERT_EQUAL_UINT8(3, cmplt);
+  /* Unregistered hooks are no longer called. */
+  Line_SetCmpltCallback(NULL, NULL);
+  helper_line_add_string("d\n", 2);
+  TEST_ASSERT_EQUAL_UINT8(3, cmplt);
+  Line_SetCmpltCallback(dummy_callback, NULL);
+  Line_Init();
+  helper_line_add_string("e\n", 2);
+  TEST_ASSERT_EQUAL_UINT8(3, cmplt);
+}
+
+#if UCMD_LATENCY
+static uint32_t stamp_ticks;
+
+static uint32_t helper_stamp_clock(void) {
+  return stamp_ticks;
+}
+
+void test_Line_completion_stamp(void) {
+  uint32_t stamp = 7;
+  Line_Init();
+  Line_SetClock(helper_stamp_clock);
+  TEST_ASSERT_EQUAL_UINT8(0, Line_GetStamp(&stamp));
+  TEST_ASSERT_EQUAL_UINT32(7, stamp);
+  /* Lines are stamped by the end of line character, not the first one. */
+  stamp_ticks = 10;
+  helper_line_add_string("ab", 2);
+  stamp_ticks = 20;
+  Line_AddChar('\n');
+  stamp_ticks = 30;
+  Line_AddChars((const uint8_t*)"c\n", 2);
+  TEST_ASSERT_EQUAL_UINT8(1, Line_GetStamp(&stamp));
+  TEST_ASSERT_EQUAL_UINT32(20, stamp);
+  Line_ReleaseBuff();
+  TEST_ASSERT_EQUAL_UINT8(1, Line_GetStamp(&stamp));
+  TEST_ASSERT_EQUAL_UINT32(30, stamp);
+  Line_ReleaseBuff();
+  TEST_ASSERT_EQUAL_UINT8(0, Line_GetStamp(&stamp));
+  Line_SetClock(NULL);
+}
+#endif
+
+/* Feed a stream in chunks, either byte by byte or in blocks, popping some lines */
+/* after each chunk. Everything popped is logged together with the final state. */
+static void helper_line_feed_log(const uint8_t* data, const size_t* chunks, const uint8_t* pops,
+                                 size_t nchunks, uint8_t bulk, char* log, size_t logsz) {
+  size_t idx;
+  size_t ch;
+  size_t used = 0;
+  uint8_t pop;
+  Line_Init();
+  for(idx = 0; idx < nchunks; idx++) {
+    if(bulk) {
+      Line_AddChars(data, chunks[idx]);
+    } else {
+      for(ch = 0; ch < chunks[idx]; ch++) {
+        Line_AddChar(data[ch]);
+      }
+    }
+    data += chunks[idx];
+    for(pop = 0; (pop < pops[idx]) && Line_IsCmplt(); pop++) {
+      Line_PopBuff(test_buff);
+      used += snprintf(&log[used], logsz - used, "[%s]", test_buff);
+    }
+  }
+  Line_GetBuff(test_buff);
+  snprintf(&log[used], logsz - used, "{%u %u %u %u %u %s}", Line_GetQueueCnt(), Line_GetDropCnt(),
+           Line_BuffIsOvrFlwn(), Line_GetCnt(), Line_IsCmplt(), test_buff);
+}
+
+void test_Line_AddChars_matches_AddChar(void) {
+  static const uint8_t alphabet[] = { 'a', 'b', 'c', ' ', LINE_CHAR_CR, LINE_CHAR_LF };
+  static uint8_t data[4096];
+  static char log_a[32768];
+  static char log_b[32768];
+  size_t chunks[256];
+  uint8_t pops[256];
+  size_t nchunks;
+  size_t total;
+  size_t idx;
+  uint32_t trial;
+  srand(1234);
+  for(trial = 0; trial < 200; trial++) {
+    /* Runs of letters get longer from one trial to the next, so that some */
+    /* of them overflow the buffer. */
+    for(idx = 0; idx < sizeof(data); idx++) {
+      data[idx] = (rand() % (4 + (trial % 4) * 24)) ? alphabet[rand() % 3] : alphabet[3 + rand() % 3];
+    }
+    for(nchunks = 0, total = 0; (nchunks < 256) && (total < sizeof(data)); nchunks++) {
+      chunks[nchunks] = 1 + rand() % 96;
+      chunks[nchunks] = (total + chunks[nchunks] > sizeof(data)) ? sizeof(data) - total : chunks[nchunks];
+      pops[nchunks] = rand() % 5;
+      total += chunks[nchunks];
+    }
+    helper_line_feed_log(data, chunks, pops, nchunks, 0, log_a, sizeof(log_a));
+    helper_line_feed_log(data, chunks, pops, nchunks, 1, log_b, sizeof(log_b));
+    TEST_ASSERT_EQUAL_STRING(log_a, log_b);
+  }
+}
+
+void test_Line_DmaRx_wraps_around(void) {
+  uint8_t dmabuf[8];
+  Line_Init();
+  /* Half transfer: first half of the buffer written. */
+  memcpy(dmabuf, "cmd1", 4);
+  Line_DmaRx(dmabuf, sizeof(dmabuf), 4);
+  TEST_ASSERT_EQUAL_UINT8(4, Line_GetCnt());
+  /* Idle line in the second half. */
+  memcpy(&dmabuf[4], "\nab", 3);
+  Line_DmaRx(dmabuf, sizeof(dmabuf), 7);
+  TEST_ASSERT_EQUAL_UINT8(1, Line_GetQueueCnt());
+  /* Data wraps around the end of the buffer before the next callback. */
+  memcpy(&dmabuf[7], "c", 1);
+  memcpy(dmabuf, "d\r", 2);
+  Line_DmaRx(dmabuf, sizeof(dmabuf), 2);
+  TEST_ASSERT_EQUAL_UINT8(2, Line_GetQueueCnt());
+  Line_PopBuff(test_buff);
+  TEST_ASSERT_EQUAL_STRING("cmd1", test_buff);
+  Line_PopBuff(test_buff);
+  TEST_ASSERT_EQUAL_STRING("abcd", test_buff);
+  /* Transfer complete reports the end of the buffer as position. */
+  memcpy(&dmabuf[2], "xyzabc", 6);
+  Line_DmaRx(dmabuf, sizeof(dmabuf), sizeof(dmabuf));
+  memcpy(dmabuf, "\n", 1);
+  Line_DmaRx(dmabuf, sizeof(dmabuf), 1);
+  Line_PopBuff(test_buff);
+  TEST_ASSERT_EQUAL_STRING("xyzabc", test_buff);
+  /* No new data, nothing happens. */
+  Line_DmaRx(dmabuf, sizeof(dmabuf), 1);
+  TEST_ASSERT_FALSE(Line_IsCmplt());
+  TEST_ASSERT_TRUE(Line_BuffIsEmpty());
+}
+
+/*-----------------------------------------------------------------------------
+ *  Producer thread standing in for the receive interrupt.
+ *-----------------------------------------------------------------------------*/
+#define STRESS_LINES (50000u) /* Stays within the 16 bit drop counter. */
+
+static atomic_int stress_done = 0;
+
+static void* helper_stress_producer(void* arg) {
+  char line[16];
+  uint32_t idx;
+  int len;
+  int ch;
+  (void)arg;
+  for(idx = 0; idx < STRESS_LINES; idx++) {
+    len = snprintf(line, sizeof(line), "L%06u\r\n", (unsigned)idx);
+    for(ch = 0; ch < len; ch++) {
+      Line_AddChar(line[ch]);
+    }
+  }
+  stress_done = 1;
+  return NULL;
+}
+
+void test_Line_spsc_stress(void) {
+  pthread_t producer;
+  uint32_t received = 0;
+  long last = -1;
+  long num;
+  char* end;
+  Line_Init();
+  stress_done = 0;
+  TEST_ASSERT_EQUAL_INT(0, pthread_create(&producer, NULL, helper_stress_producer, NULL));
+  /* Consume lines as they come, without any lock. Each line must be intact */
+  /* and lines must come out in the order they were produced. */
+  while(!stress_done || Line_IsCmplt()) {
+    if(Line_IsCmplt()) {
+      Line_PopBuff(test_buff);
+      TEST_ASSERT_EQUAL_UINT8('L', test_buff[0]);
+      num = strtol((char*)&test_buff[1], &end, 10);
+      TEST_ASSERT_EQUAL_INT(7, (int)(end - (char*)test_buff));
+      TEST_ASSERT_EQUAL_UINT8('\0', *end);
+      TEST_ASSERT_TRUE(num > last);
+      last = num;
+      received++;
+    }
+  }
+  pthread_join(producer, NULL);
+  while(Line_IsCmplt()) {
+    Line_PopBuff(test_buff);
+    received++;
+  }
+  /* Every line was either received or counted as dropped. */
+  TEST_ASSERT_EQUAL_UINT32(STRESS_LINES, received + Line_GetDropCnt());
+  TEST_ASSERT_TRUE(received > 0);
+}
+
 void test_line_all_tests(void) {
   RUN_TEST(test_Line_Init_function);
   RUN_TEST(test_Line_NewCharCallback_add_chars);
   RUN_TEST(test_Line_BufferIsFull_flag);
   RUN_TEST(test_Line_new_ch_proc_ignore_eol_on_empty_buf);
   RUN_TEST(test_Line_FlushBuff);
+  RUN_TEST(test_Line_FlushBuff_keeps_line_in_reception);
   RUN_TEST(test_Line_IsCmplt);
   RUN_TEST(test_Line_longest_command_wo_oveflow);
+  RUN_TEST(test_Line_BuffIsFull_reports_oldest_line);
   RUN_TEST(test_Line_buffer_overflow_behavior);
+  RUN_TEST(test_Line_queue_keeps_lines_in_order);
+  RUN_TEST(test_Line_queue_full_drops_lines);
+  RUN_TEST(test_Line_acquire_release_in_place);
+  RUN_TEST(test_Line_AddChars_matches_AddChar);
+  RUN_TEST(test_Line_DmaRx_wraps_around);
+  RUN_TEST(test_Line_event_callbacks);
+  RUN_TEST(test_Line_spsc_stress);
+#if UCMD_LATENCY
+  RUN_TEST(test_Line_completion_stamp);
+#endif
 }
@@ -0,0 +1,234 @@
+#include "unity.h"
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include "tx.h"
+
+/*-----------------------------------------------------------------------------
+ *  Helper functions and variables.
+ *-----------------------------------------------------------------------------*/
+#define STRESS_BYTES (200000)
+
+static uint8_t sent[TX_BUFF_SIZE * 4];
+static size_t sentcnt;
+static size_t draincnt;
+static volatile int stress_done;
+static uint32_t stress_errs;
+
+/* Drain everything at once, as a DMA transfer completing at once would. */
+static void helper_drain_all(TxCtx_s* ctx, void* arg) {
+  const uint8_t* data;
+  size_t len;
+  draincnt++;
+  TEST_ASSERT_EQUAL_PTR(&draincnt, arg);
+  while((len = TxCtx_Peek(ctx, &data)) != 0) {
+    memcpy(&sent[sentcnt], data, len);
+    sentcnt += len;
+    TxCtx_Consume(ctx, len);
+  }
+}
+
+/* Take what is queued, through the byte interface. */
+static size_t helper_get_bytes(uint8_t* out, size_t outsz) {
+  size_t cnt = 0;
+  while((cnt < outsz) && Tx_GetByte(&out[cnt])) {
+    cnt++;
+  }
+  return cnt;
+}
+
+/*-----------------------------------------------------------------------------
+ *  Tests.
+ *-----------------------------------------------------------------------------*/
+void test_Tx_Init_function(void) {
+  const uint8_t* data = NULL;
+  uint8_t byte;
+  Tx_Init();
+  TEST_ASSERT_EQUAL_UINT16(0, Tx_GetCnt());
+  TEST_ASSERT_EQUAL_UINT16(0, Tx_GetDropCnt());
+  TEST_ASSERT_EQUAL_UINT(0, Tx_Peek(&data));
+  TEST_ASSERT_EQUAL_UINT8(0, Tx_GetByte(&byte));
+  TEST_ASSERT_EQUAL(E_NULL_PTR, Tx_Write(NULL, 1));
+  TEST_ASSERT_EQUAL(E_OK, Tx_Write("", 0));
+  TEST_ASSERT_EQUAL_UINT16(0, Tx_GetCnt());
+}
+
+void test_Tx_write_and_get_bytes(void) {
+  uint8_t out[16];
+  Tx_Init();
+  TEST_ASSERT_EQUAL(E_OK, Tx_Write("abc", 3));
+  TEST_ASSERT_EQUAL(E_OK, Tx_Write("de", 2));
+  TEST_ASSERT_EQUAL_UINT16(5, Tx_GetCnt());
+  TEST_ASSERT_EQUAL_UINT(5, helper_get_bytes(out, sizeof(out)));
+  TEST_ASSERT_EQUAL_MEMORY("abcde", out, 5);
+  TEST_ASSERT_EQUAL_UINT16(0, Tx_GetCnt());
+}
+
+void test_Tx_peek_wraps_around(void) {
+  static uint8_t fill[TX_BUFF_SIZE];
+  const uint8_t* data;
+  size_t len;
+  Tx_Init();
+  memset(fill, 'x', sizeof(fill));
+  /* Move the ring 3 bytes before its end, then write across it. */
+  TEST_ASSERT_EQUAL(E_OK, Tx_Write(fill, TX_BUFF_SIZE - 3));
+  Tx_Consume(TX_BUFF_SIZE - 3);
+  TEST_ASSERT_EQUAL(E_OK, Tx_Write("12345", 5));
+  len = Tx_Peek(&data);
+  TEST_ASSERT_EQUAL_UINT(3, len);
+  TEST_ASSERT_EQUAL_MEMORY("123", data, 3);
+  Tx_Consume(len);
+  len = Tx_Peek(&data);
+  TEST_ASSERT_EQUAL_UINT(2, len);
+  TEST_ASSERT_EQUAL_MEMORY("45", data, 2);
+  /* Releasing more than what is queued stops at the queued bytes. */
+  Tx_Consume(10);
+  TEST_ASSERT_EQUAL_UINT16(0, Tx_GetCnt());
+}
+
+void test_Tx_full_ring_drops_whole_writes(void) {
+  static uint8_t fill[TX_BUFF_SIZE];
+  uint8_t out[4];
+  Tx_Init();
+  memset(fill, 'x', sizeof(fill));
+  TEST_ASSERT_EQUAL(E_OK, Tx_Write(fill, TX_BUFF_SIZE - 2));
+  /* Three bytes do not fit in two: nothing is queued. */
+  TEST_ASSERT_EQUAL(E_TOO_LARGE, Tx_Write("abc", 3));
+  TEST_ASSERT_EQUAL_UINT16(1, Tx_GetDropCnt());
+  TEST_ASSERT_EQUAL_UINT16(TX_BUFF_SIZE - 2, Tx_GetCnt());
+  TEST_ASSERT_EQUAL(E_OK, Tx_Write("ab", 2));
+  TEST_ASSERT_EQUAL_UINT16(TX_BUFF_SIZE, Tx_GetCnt());
+  TEST_ASSERT_EQUAL(E_TOO_LARGE, Tx_Write("c", 1));
+  TEST_ASSERT_EQUAL_UINT16(2, Tx_GetDropCnt());
+  Tx_Consume(TX_BUFF_SIZE - 2);
+  TEST_ASSERT_EQUAL_UINT(2, helper_get_bytes(out, sizeof(out)));
+  TEST_ASSERT_EQUAL_MEMORY("ab", out, 2);
+  TEST_ASSERT_EQUAL(E_TOO_LARGE, Tx_Write(fill, TX_BUFF_SIZE + 1));
+}
+
+void test_Tx_WriteStr_is_one_write(void) {
+  static uint8_t fill[TX_BUFF_SIZE];
+  const char* const str_a[] = {"pwm", ": ", "OK", ".\n\r"};
+  const char* const null_a[] = {"a", NULL};
+  uint8_t out[32];
+  Tx_Init();
+  TEST_ASSERT_EQUAL(E_OK, Tx_WriteStr(str_a, 4));
+  TEST_ASSERT_EQUAL_UINT(10, helper_get_bytes(out, sizeof(out)));
+  TEST_ASSERT_EQUAL_MEMORY("pwm: OK.\n\r", out, 10);
+  TEST_ASSERT_EQUAL(E_NULL_PTR, Tx_WriteStr(null_a, 2));
+  TEST_ASSERT_EQUAL(E_NULL_PTR, Tx_WriteStr(NULL, 1));
+  TEST_ASSERT_EQUAL_UINT16(0, Tx_GetCnt());
+  /* Pieces that fit alone but not together are all dropped. */
+  memset(fill, 'x', sizeof(fill));
+  TEST_ASSERT_EQUAL(E_OK, Tx_Write(fill, TX_BUFF_SIZE - 8));
+  TEST_ASSERT_EQUAL(E_TOO_LARGE, Tx_WriteStr(str_a, 4));
+  TEST_ASSERT_EQUAL_UINT16(TX_BUFF_SIZE - 8, Tx_GetCnt());
+  TEST_ASSERT_EQUAL_UINT16(1, Tx_GetDropCnt());
+}
+
+void test_Tx_drain_hook(void) {
+  size_t i;
+  Tx_Init();
+  sentcnt = 0;
+  draincnt = 0;
+  Tx_SetDrain(helper_drain_all, &draincnt);
+  /* The drained ring never fills, whatever the amount written. */
+  for(i = 0; i < 3 * TX_BUFF_SIZE / 4; i++) {
+    TEST_ASSERT_EQUAL(E_OK, Tx_Write("0123", 4));
+  }
+  TEST_ASSERT_EQUAL_UINT(3 * TX_BUFF_SIZE / 4, draincnt);
+  TEST_ASSERT_EQUAL_UINT(3 * TX_BUFF_SIZE, sentcnt);
+  TEST_ASSERT_EQUAL_MEMORY("01230123", &sent[TX_BUFF_SIZE - 4], 8);
+  TEST_ASSERT_EQUAL_UINT16(0, Tx_GetCnt());
+  Tx_SetDrain(NULL, NULL);
+  TEST_ASSERT_EQUAL(E_OK, Tx_Write("0123", 4));
+  TEST_ASSERT_EQUAL_UINT(3 * TX_BUFF_SIZE / 4, draincnt);
+  TEST_ASSERT_EQUAL_UINT16(4, Tx_GetCnt());
+}
+
+void test_Tx_instances_are_independent(void) {
+  static TxCtx_s ctx_a, ctx_b;
+  const uint8_t* data;
+  TxCtx_Init(&ctx_a);
+  TxCtx_Init(&ctx_b);
+  TEST_ASSERT_EQUAL(E_OK, TxCtx_Write(&ctx_a, "a", 1));
+  TEST_ASSERT_EQUAL(E_OK, TxCtx_Write(&ctx_b, "bb", 2));
+  TEST_ASSERT_EQUAL_UINT(1, TxCtx_Peek(&ctx_a, &data));
+  TEST_ASSERT_EQUAL_UINT8('a', data[0]);
+  TEST_ASSERT_EQUAL_UINT(2, TxCtx_Peek(&ctx_b, &data));
+  TEST_ASSERT_EQUAL_UINT8('b', data[0]);
+  TEST_ASSERT_TRUE(Tx_GetCtx() != &ctx_a);
+}
+
+void test_print_err_uses_tx(void) {
+  uint8_t out[64];
+  size_t len;
+  Tx_Init();
+  print_err("pwm", E_INV_ARG);
+  len = helper_get_bytes(out, sizeof(out));
+  TEST_ASSERT_EQUAL_UINT(strlen("pwm: Invalid Argument.\n\r"), len);
+  TEST_ASSERT_EQUAL_MEMORY("pwm: Invalid Argument.\n\r", out, len);
+  print_err("x", E_LAST_ELEM);
+  len = helper_get_bytes(out, sizeof(out));
+  TEST_ASSERT_EQUAL_MEMORY("x: Unknown Error.\n\r", out, len);
+}
+
+static void* helper_stress_drain(void* arg) {
+  uint32_t* received = arg;
+  const uint8_t* data;
+  size_t len, i;
+  while(!stress_done || Tx_GetCnt()) {
+    len = Tx_Peek(&data);
+    for(i = 0; i < len; i++) {
+      /* Bytes count up from zero, each one intact and in order. */
+      stress_errs += (data[i] != (uint8_t)*received);
+      (*received)++;
+    }
+    Tx_Consume(len);
+    if(!len) {
+      sched_yield();
+    }
+  }
+  return NULL;
+}
+
+void test_Tx_spsc_stress(void) {
+  pthread_t drain;
+  uint32_t received = 0;
+  uint32_t written = 0;
+  uint8_t chunk[7];
+  size_t len, i;
+  Tx_Init();
+  stress_done = 0;
+  stress_errs = 0;
+  TEST_ASSERT_EQUAL_INT(0, pthread_create(&drain, NULL, helper_stress_drain, &received));
+  /* Write without any lock, retrying dropped writes. */
+  while(written < STRESS_BYTES) {
+    len = 1 + (size_t)(rand() % (int)sizeof(chunk));
+    for(i = 0; i < len; i++) {
+      chunk[i] = (uint8_t)(written + i);
+    }
+    if(Tx_Write(chunk, len) == E_OK) {
+      written += (uint32_t)len;
+    } else {
+      sched_yield();
+    }
+  }
+  stress_done = 1;
+  pthread_join(drain, NULL);
+  TEST_ASSERT_EQUAL_UINT32(written, received);
+  TEST_ASSERT_EQUAL_UINT32(0, stress_errs);
+}
+
+void test_tx_all_tests(void) {
+  RUN_TEST(test_Tx_Init_function);
+  RUN_TEST(test_Tx_write_and_get_bytes);
+  RUN_TEST(test_Tx_peek_wraps_around);
+  RUN_TEST(test_Tx_full_ring_drops_whole_writes);
+  RUN_TEST(test_Tx_WriteStr_is_one_write);
+  RUN_TEST(test_Tx_drain_hook);
+  RUN_TEST(test_Tx_instances_are_independent);
+  RUN_TEST(test_print_err_uses_tx);
+  RUN_TEST(test_Tx_spsc_stress);
+}
@@ -3,6 +3,7 @@
 #include <assert.h>
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #define MODUDLE_NAME "utils"
 
@@ -160,6 +161,53 @@ void test_strtou32(void) {
 
   ret = strtou32("12--23", &num);
   TEST_ASSERT_EQUAL_INT32((int32_t)E_OUT_OF_RANGE, (int32_t)ret);
+
+  /* Values above UINT32_MAX must not wrap. */
+  ret = strtou32("4294967296", &num);
+  TEST_ASSERT_EQUAL_INT32((int32_t)E_OUT_OF_RANGE, (int32_t)ret);
+
+  ret = strtou32("99999999999999999999", &num);
+  TEST_ASSERT_EQUAL_INT32((int32_t)E_OUT_OF_RANGE, (int32_t)ret);
+
+  ret = strtou32("00000000000004294967295", &num);
+  TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
+  TEST_ASSERT_EQUAL_UINT32((uint32_t)4294967295, (uint32_t)num);
+
+  /* Invalid characters inside blocks of 4 and 8 digits. */
+  ret = strtou32("1234567/", &num);
+  TEST_ASSERT_EQUAL_INT32((int32_t)E_OUT_OF_RANGE, (int32_t)ret);
+
+  ret = strtou32("12:4", &num);
+  TEST_ASSERT_EQUAL_INT32((int32_t)E_OUT_OF_RANGE, (int32_t)ret);
+
+  ret = strtou32("123456789 ", &num);
+  TEST_ASSERT_EQUAL_INT32((int32_t)E_OUT_OF_RANGE, (int32_t)ret);
+
+  /* Only the given length is converted. */
+  ret = strntou32("12345678901", 9, &num);
+  TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
+  TEST_ASSERT_EQUAL_UINT32((uint32_t)123456789, (uint32_t)num);
+}
+
+void test_strtou32_matches_reference(void) {
+  char str[24];
+  uint32_t num;
+  uint64_t val;
+  ErrCode_e ret;
+  int i;
+  srand(5);
+  for(i = 0; i < 20000; i++) {
+    /* Values spread over every digit count, and a bit past UINT32_MAX. */
+    val = ((uint64_t)rand() << 31 | (uint64_t)rand()) >> (rand() % 60);
+    snprintf(str, sizeof(str), "%0*llu", rand() % 14, (unsigned long long)val);
+    ret = strtou32(str, &num);
+    if(val <= UINT32_MAX) {
+      TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
+      TEST_ASSERT_EQUAL_UINT32((uint32_t)val, num);
+    } else {
+      TEST_ASSERT_EQUAL_INT32((int32_t)E_OUT_OF_RANGE, (int32_t)ret);
+    }
+  }
 }
 
 void test_strtoi32(void) {
@@ -183,7 +231,6 @@ void test_strtoi32(void) {
   /*************************************************************************/
   /* TEST BODY AND VALIDATION **********************************************/
   /*************************************************************************/
-  /* TODO: Test positive and negative extreme values. */
 
   ret = strtoi32("230", &num);
   TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
@@ -204,4 +251,49 @@ void test_strtoi32(void) {
 
   ret = strtoi32("12--23", &num);
   TEST_ASSERT_EQUAL_INT32((int32_t)E_OUT_OF_RANGE, (int32_t)ret);
+
+  ret = strtoi32("-", &num);
+  TEST_ASSERT_EQUAL_INT32((int32_t)E_INV_SIZE, (int32_t)ret);
+
+  ret = strtoi32("2147483647", &num);
+  TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
+  TEST_ASSERT_EQUAL_INT32(INT32_MAX, num);
+
+  ret = strtoi32("-2147483648", &num);
+  TEST_ASSERT_EQUAL_INT32((int32_t)E_OK, (int32_t)ret);
+  TEST_ASSERT_EQUAL_INT32(INT32_MIN, num);
+
+  ret = strtoi32("2147483648", &num);
+  TEST_ASSERT_EQUAL_INT32((int32_t)E_OUT_OF_RANGE, (int32_t)ret);
+
+  ret = strtoi32("-2147483649", &num);
+  TEST_ASSERT_EQUAL_INT32((int32_t)E_OUT_OF_RANGE, (int32_t)ret);
+}
+
+void test_crc16(void) {
+  /*************************************************************************/
+  /* TEST SETUP ************************************************************/
+  /*************************************************************************/
+  const uint8_t check[] = "123456789";
+  uint16_t crc;
+  size_t i;
+
+  /*************************************************************************/
+  /* TEST ARGUMENT VALIDATION **********************************************/
+  /*************************************************************************/
+  TEST_ASSERT_EQUAL_HEX16(CRC16_INIT, crc16(CRC16_INIT, NULL, 4));
+  TEST_ASSERT_EQUAL_HEX16(CRC16_INIT, crc16(CRC16_INIT, check, 0));
+
+  /*************************************************************************/
+  /* TEST BODY AND VALIDATION **********************************************/
+  /*************************************************************************/
+  /* Check value of CRC-16/CCITT-FALSE. */
+  TEST_ASSERT_EQUAL_HEX16(0x29B1, crc16(CRC16_INIT, check, 9));
+
+  /* Carried on byte by byte. */
+  crc = CRC16_INIT;
+  for(i = 0; i < 9; i++) {
+    crc = crc16(crc, &check[i], 1);
+  }
+  TEST_ASSERT_EQUAL_HEX16(0x29B1, crc);
 }
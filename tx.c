@@ -0,0 +1,187 @@
+#include "tx.h"
+#include <string.h>
+
+#ifdef UNIT_TEST
+#define STATIC
+#else
+#define STATIC static
+#endif
+
+#define _idx_load(idx, order) TX_IDX_LOAD(idx, order)
+#define _idx_store(idx, val, order) TX_IDX_STORE(idx, val, order)
+
+/* Ring positions run freely on 16 bits, the buffer must divide their range. */
+UCMD_STATIC_ASSERT((0x10000 % TX_BUFF_SIZE) == 0, "TX_BUFF_SIZE must divide the range of TxIdx_t.");
+
+/*-----------------------------------------------------------------------------
+ *  Static global variables.
+ *-----------------------------------------------------------------------------*/
+static TxCtx_s _tx_s; /* Instance behind the Tx_ functions and print_err. */
+
+/*-----------------------------------------------------------------------------
+ * Static function prototypes. 
+ *-----------------------------------------------------------------------------*/
+static inline uint16_t _ring_cnt(TxCtx_s*);
+static inline uint16_t _ring_put(TxCtx_s*, uint16_t, const uint8_t*, size_t);
+static inline ErrCode_e _ring_reserve(TxCtx_s*, size_t);
+static inline void _ring_commit(TxCtx_s*, uint16_t);
+
+/* Both sides see a count that is at most stale in the safe direction: the */
+/* writer may see bytes not yet sent, the drain side may miss new bytes. */
+static inline uint16_t _ring_cnt ( TxCtx_s* ctx )
+{
+  return (uint16_t)(_idx_load(ctx->head, acquire) - _idx_load(ctx->tail, acquire));
+}
+
+/* Copy at position pos, in at most two pieces, and return the next position. */
+static inline uint16_t _ring_put ( TxCtx_s* ctx, uint16_t pos, const uint8_t* data, size_t len )
+{
+  size_t ofs = pos % TX_BUFF_SIZE;
+  size_t first = ((TX_BUFF_SIZE - ofs) < len) ? (TX_BUFF_SIZE - ofs) : len;
+  memcpy(&ctx->buff[ofs], data, first);
+  memcpy(ctx->buff, &data[first], len - first);
+  return (uint16_t)(pos + len);
+}
+
+/* A write that does not fit as a whole is dropped, never cut. */
+static inline ErrCode_e _ring_reserve ( TxCtx_s* ctx, size_t len )
+{
+  ErrCode_e ret = E_OK;
+  if(len > (size_t)(TX_BUFF_SIZE - _ring_cnt(ctx))) {
+    ctx->drops++;
+    ret = E_TOO_LARGE;
+  }
+  return ret;
+}
+
+/* Publish the bytes copied up to head, then let the transmitter know. */
+static inline void _ring_commit ( TxCtx_s* ctx, uint16_t head )
+{
+  _idx_store(ctx->head, head, release);
+  if(ctx->drain) {
+    ctx->drain(ctx, ctx->drain_arg);
+  }
+}
+
+void TxCtx_Init ( TxCtx_s* ctx )
+{
+  memset(ctx->buff, 0, sizeof(ctx->buff));
+  _idx_store(ctx->head, 0, relaxed);
+  _idx_store(ctx->tail, 0, relaxed);
+  ctx->drops = 0;
+  ctx->drain = NULL;
+  ctx->drain_arg = NULL;
+}
+
+void TxCtx_SetDrain ( TxCtx_s* ctx, Tx_Drain drain, void* arg )
+{
+  ctx->drain = drain;
+  ctx->drain_arg = arg;
+}
+
+ErrCode_e TxCtx_Write ( TxCtx_s* ctx, const void* data, size_t len )
+{
+  ErrCode_e ret = E_GENERIC;
+  if(ctx && data) {
+    ret = _ring_reserve(ctx, len);
+    if((ret == E_OK) && len) {
+      _ring_commit(ctx, _ring_put(ctx, _idx_load(ctx->head, relaxed), data, len));
+    }
+  } else {
+    ret = E_NULL_PTR;
+  }
+  return ret;
+}
+
+/* Strings are copied as they are scanned, the free space bounding the copy. */
+/* Nothing is visible to the drain side until head is published, so a write */
+/* that runs out of space is dropped by not publishing it. */
+ErrCode_e TxCtx_WriteStr ( TxCtx_s* ctx, const char* const* strs, size_t cnt )
+{
+  ErrCode_e ret = E_GENERIC;
+  size_t i;
+  uint16_t head, end;
+  const char* str;
+  if(ctx && strs) {
+    ret = E_OK;
+    for(i = 0; (i < cnt) && (ret == E_OK); i++) {
+      ret = strs[i] ? E_OK : E_NULL_PTR;
+    }
+    head = _idx_load(ctx->head, relaxed);
+    end = (uint16_t)(_idx_load(ctx->tail, acquire) + TX_BUFF_SIZE);
+    for(i = 0; (i < cnt) && (ret == E_OK); i++) {
+      for(str = strs[i]; *str && (head != end); str++, head++) {
+        ctx->buff[head % TX_BUFF_SIZE] = (uint8_t)*str;
+      }
+      if(*str) {
+        ctx->drops++;
+        ret = E_TOO_LARGE;
+      }
+    }
+    if((ret == E_OK) && (head != _idx_load(ctx->head, relaxed))) {
+      _ring_commit(ctx, head);
+    }
+  } else {
+    ret = E_NULL_PTR;
+  }
+  return ret;
+}
+
+size_t TxCtx_Peek ( TxCtx_s* ctx, const uint8_t** data )
+{
+  size_t ofs = _idx_load(ctx->tail, relaxed) % TX_BUFF_SIZE;
+  size_t cnt = _ring_cnt(ctx);
+  *data = &ctx->buff[ofs];
+  return ((TX_BUFF_SIZE - ofs) < cnt) ? (TX_BUFF_SIZE - ofs) : cnt;
+}
+
+void TxCtx_Consume ( TxCtx_s* ctx, size_t len )
+{
+  size_t cnt = _ring_cnt(ctx);
+  len = (len < cnt) ? len : cnt;
+  _idx_store(ctx->tail, (uint16_t)(_idx_load(ctx->tail, relaxed) + len), release);
+}
+
+uint8_t TxCtx_GetByte ( TxCtx_s* ctx, uint8_t* byte )
+{
+  uint16_t tail = _idx_load(ctx->tail, relaxed);
+  uint8_t ret = (_ring_cnt(ctx) != 0);
+  if(ret) {
+    *byte = ctx->buff[tail % TX_BUFF_SIZE];
+    _idx_store(ctx->tail, (uint16_t)(tail + 1), release);
+  }
+  return ret;
+}
+
+uint16_t TxCtx_GetCnt ( TxCtx_s* ctx )
+{
+  return _ring_cnt(ctx);
+}
+
+uint16_t TxCtx_GetDropCnt ( TxCtx_s* ctx )
+{
+  return ctx->drops;
+}
+
+/*-----------------------------------------------------------------------------
+ *  Default instance.
+ *-----------------------------------------------------------------------------*/
+TxCtx_s* Tx_GetCtx (void) { return &_tx_s; }
+
+void Tx_Init (void) { TxCtx_Init(&_tx_s); }
+
+void Tx_SetDrain (Tx_Drain drain, void* arg) { TxCtx_SetDrain(&_tx_s, drain, arg); }
+
+ErrCode_e Tx_Write (const void* data, size_t len) { return TxCtx_Write(&_tx_s, data, len); }
+
+ErrCode_e Tx_WriteStr (const char* const* strs, size_t cnt) { return TxCtx_WriteStr(&_tx_s, strs, cnt); }
+
+size_t Tx_Peek (const uint8_t** data) { return TxCtx_Peek(&_tx_s, data); }
+
+void Tx_Consume (size_t len) { TxCtx_Consume(&_tx_s, len); }
+
+uint8_t Tx_GetByte (uint8_t* byte) { return TxCtx_GetByte(&_tx_s, byte); }
+
+uint16_t Tx_GetCnt (void) { return TxCtx_GetCnt(&_tx_s); }
+
+uint16_t Tx_GetDropCnt (void) { return TxCtx_GetDropCnt(&_tx_s); }
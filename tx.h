@@ -0,0 +1,153 @@
+#ifndef TX_H
+#define TX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "err.h"
+#include "line.h"
+#include "ucmd_config.h"
+
+/*-----------------------------------------------------------------------------
+ *  Macro detiniftions.
+ *-----------------------------------------------------------------------------*/
+/* TX_BUFF_SIZE comes from ucmd_config.h. */
+
+/* The ring is a single producer (main loop) single consumer (transmit interrupt */
+/* or DMA completion) queue of bytes, the mirror of the Line queue. Positions are */
+/* 16 bits: without C11 atomics the target must read and write them in one access, */
+/* as 16 and 32-bit cores do. */
+#if LINE_LOCK_FREE
+typedef atomic_uint_least16_t TxIdx_t;
+#define TX_IDX_LOAD(idx, order) LINE_IDX_LOAD(idx, order)
+#else
+typedef volatile uint16_t TxIdx_t;
+#define TX_IDX_LOAD(idx, order) Tx_IdxLoad(&(idx))
+static inline uint16_t Tx_IdxLoad(TxIdx_t* idx) {
+  uint16_t val = *idx;
+  LINE_COMPILER_BARRIER();
+  return val;
+}
+#endif
+#define TX_IDX_STORE(idx, val, order) LINE_IDX_STORE(idx, val, order)
+
+/*-----------------------------------------------------------------------------
+ * Type definitions. 
+ *-----------------------------------------------------------------------------*/
+struct TxCtx;
+
+/* Hook called from the writing context each time bytes are queued. It starts */
+/* the transmitter if it is idle: a DMA transfer over Tx_Peek, or the transmit */
+/* empty interrupt fed by Tx_GetByte. It is called again while a transfer runs */
+/* and must then leave it alone. */
+typedef void (*Tx_Drain)(struct TxCtx* ctx, void* arg);
+
+/* One transmit channel. Storage is provided by the caller, members are private. */
+typedef struct TxCtx {
+  uint8_t buff[TX_BUFF_SIZE];
+  TxIdx_t head; /* Bytes queued. Only the writer moves it. */
+  TxIdx_t tail; /* Bytes sent. Only the drain side moves it. */
+  volatile uint16_t drops; /* Writes dropped as the ring was full. */
+  Tx_Drain drain;
+  void* drain_arg;
+} TxCtx_s;
+
+/* 
+ * ===  FUNCTION  ======================================================================
+ *         Name:  Tx_Init
+ *  Description:  Initialize the Tx module. The ring is emptied and the drain hook
+                  cleared, register it after this call.
+ * =====================================================================================
+ */
+void Tx_Init(void);
+
+/* 
+ * ===  FUNCTION  ======================================================================
+ *         Name:  Tx_SetDrain
+ *  Description:  Register the hook that starts the transmitter. NULL unregisters it,
+                  bytes then wait until the drain side fetches them.
+ * =====================================================================================
+ */
+void Tx_SetDrain(Tx_Drain drain, void* arg);
+
+/* 
+ * ===  FUNCTION  ======================================================================
+ *         Name:  Tx_Write
+ *  Description:  Queue len bytes and return at once. Writes are whole: if the ring
+                  has no room for all of them, none is queued, the write is counted
+                  as dropped and E_TOO_LARGE is returned. Main loop only.
+ * =====================================================================================
+ */
+ErrCode_e Tx_Write(const void* data, size_t len);
+
+/* 
+ * ===  FUNCTION  ======================================================================
+ *         Name:  Tx_WriteStr
+ *  Description:  Same as Tx_Write, for cnt strings queued back to back as one write,
+                  so that a reply built from pieces is never cut.
+ * =====================================================================================
+ */
+ErrCode_e Tx_WriteStr(const char* const* strs, size_t cnt);
+
+/* 
+ * ===  FUNCTION  ======================================================================
+ *         Name:  Tx_Peek
+ *  Description:  Drain side. Point data to the oldest queued bytes and return how many
+                  are contiguous, 0 if none. Bytes that wrap around the end of the ring
+                  come with the next call, once these are consumed. Meant for DMA.
+ * =====================================================================================
+ */
+size_t Tx_Peek(const uint8_t** data);
+
+/* 
+ * ===  FUNCTION  ======================================================================
+ *         Name:  Tx_Consume
+ *  Description:  Drain side. Release len bytes returned by Tx_Peek once they are sent.
+ * =====================================================================================
+ */
+void Tx_Consume(size_t len);
+
+/* 
+ * ===  FUNCTION  ======================================================================
+ *         Name:  Tx_GetByte
+ *  Description:  Drain side. Take the oldest queued byte, returns 0 if there is none.
+                  Meant for the transmit empty interrupt.
+ * =====================================================================================
+ */
+uint8_t Tx_GetByte(uint8_t* byte);
+
+/* 
+ * ===  FUNCTION  ======================================================================
+ *         Name:  Tx_GetCnt
+ *  Description:  Get the number of bytes waiting to be sent.
+ * =====================================================================================
+ */
+uint16_t Tx_GetCnt(void);
+
+/* 
+ * ===  FUNCTION  ======================================================================
+ *         Name:  Tx_GetDropCnt
+ *  Description:  Get the number of writes dropped because the ring was full.
+ * =====================================================================================
+ */
+uint16_t Tx_GetDropCnt(void);
+
+/* 
+ * ===  FUNCTIONS  =====================================================================
+ *         Name:  TxCtx_*
+ *  Description:  Each Tx_ function above works on a default instance, the one print_err
+                  writes to. The TxCtx_ functions do the same on the instance given as
+                  first argument. Different instances share no state.
+ * =====================================================================================
+ */
+TxCtx_s* Tx_GetCtx(void);
+void TxCtx_Init(TxCtx_s* ctx);
+void TxCtx_SetDrain(TxCtx_s* ctx, Tx_Drain drain, void* arg);
+ErrCode_e TxCtx_Write(TxCtx_s* ctx, const void* data, size_t len);
+ErrCode_e TxCtx_WriteStr(TxCtx_s* ctx, const char* const* strs, size_t cnt);
+size_t TxCtx_Peek(TxCtx_s* ctx, const uint8_t** data);
+void TxCtx_Consume(TxCtx_s* ctx, size_t len);
+uint8_t TxCtx_GetByte(TxCtx_s* ctx, uint8_t* byte);
+uint16_t TxCtx_GetCnt(TxCtx_s* ctx);
+uint16_t TxCtx_GetDropCnt(TxCtx_s* ctx);
+
+#endif
@@ -4,6 +4,10 @@
 #include "utils.h"
 #include "ucmd.h"
 #include "line.h"
+#if UCMD_STATS || UCMD_TRACE
+#include "fmt.h"
+#include "tx.h"
+#endif
 
 #ifndef UNIT_TEST
 /*
@@ -24,148 +28,498 @@
 #define uCMD_UNLOCK()
 #endif
 
+/* Handing a line over between the receive interrupt and the main loop only
+ * needs a lock when the Line queue is not lock-free. The lock then covers the
+ * ownership swap alone: parsing and callbacks run with interrupts enabled. */
+#if LINE_LOCK_FREE
+#define _LINE_LOCK()
+#define _LINE_UNLOCK()
+#else
+#define _LINE_LOCK() uCMD_LOCK()
+#define _LINE_UNLOCK() uCMD_UNLOCK()
+#endif
+
 #define CHAR_SPACE 0x20
 #define LAST_ARR_ELEM 0x00
 
+#define ARG_NAME_BIT_NONE (64)
+#define ARG_SLOT_NONE (0xFF)
+
+#define STREAM_IDLE (0) /* Between lines, blanks are skipped. */
+#define STREAM_NAME (1)
+#define STREAM_ARG_START (2) /* After a word break, an argument name is expected. */
+#define STREAM_ARG_VALUE (3)
+#define STREAM_SKIP (4) /* The line failed, its end is awaited to queue the error. */
+#define STREAM_DROP (5) /* The queue was full when the line started. */
+#define STREAM_ACC_SAT ((uint64_t)UINT32_MAX + 1u)
+
+#define STATS_UNTIMED (UINT32_MAX) /* The stage was not timed. */
+#define TRACE_PATH_DEPTH (4) /* Sub-table levels searched by the trace dump. */
+
+/* Fields sized for the limits of ucmd_config.h. */
+UCMD_STATIC_ASSERT(UCMD_TABLE_MAX_SIZE < UCMD_HASH_SEED_DIRECT, "Command indexes do not fit in a hash slot.");
+UCMD_STATIC_ASSERT(UCMD_ARG_MAX_SIZE < ARG_SLOT_NONE, "Argument slots are indexed on a byte.");
+UCMD_STATIC_ASSERT(sizeof(((uCmdArgIdx_s*)0)->mask) * 8 >= ARG_NAME_BIT_NONE, "Argument names do not fit in the mask.");
+UCMD_STATIC_ASSERT(sizeof(((Arg_s*)0)->data) >= sizeof(uint32_t), "Argument storage cannot hold 32-bit values.");
+
+#define HASH_FNV_OFFSET (2166136261u)
+#define HASH_FNV_PRIME (16777619u)
+
 const char WrdBrkCh_c = CHAR_SPACE;
-STATIC uCmdTable_s _cmdtable_p_s = {0};
+STATIC uCmdCtx_s _ucmd_ctx; /* Instance behind the uCmd_ functions. */
+#if UCMD_STREAM
+STATIC uCmdStream_s _ucmd_stream; /* Parser behind the uCmd_Stream functions. */
+#endif
+#if UCMD_FRAME
+STATIC uCmdFrame_s _ucmd_frame; /* Receiver behind the uCmd_Frame functions. */
+#endif
+#if UCMD_CLOCK
+static uCmd_Clock _ucmd_clock; /* Clock of the time histograms and latencies. */
+#endif
+#if UCMD_REGISTRY
+/* Bounds of the UCMD_REGISTER entries, set by the linker. Both are NULL when
+   nothing is registered and the section does not exist. */
+extern const uCmdInfo_s __start_ucmd_cmds[] __attribute__((weak));
+extern const uCmdInfo_s __stop_ucmd_cmds[] __attribute__((weak));
+#endif
 
 /*****************************************************************************/
 /* Handle raw string conversion to actual numeric values. ********************/
 /*****************************************************************************/
-typedef ErrCode_e _strtonum_t(const char* rawstr, void* buf);
+/* Store a converted value with the width of its argument type. The argument
+   storage has no alignment guarantee, the fixed size copy is a plain store. */
+#define _ARG_STORE(_data, _type, _val) do { \
+    _type _tmp = (_type)(_val); \
+    memcpy((_data), &_tmp, sizeof(_tmp)); \
+  } while(0)
 
-ErrCode_e _strtoi32(const char* rawstr, void* buf) {
-  ErrCode_e ret = E_GENERIC;
-  int32_t tmp = 0;
-  if(rawstr && buf) {
-    ret = strtoi32(rawstr, &tmp);
-  } else {
-    ret = E_NULL_PTR;
+/* Number of bytes an argument type takes in memory. */
+static inline size_t _arg_width(ArgType_e argtype) {
+  size_t width = 0;
+  switch(argtype) {
+    case E_ARG_U8:
+    case E_ARG_I8:
+      width = sizeof(uint8_t);
+      break;
+    case E_ARG_U16:
+    case E_ARG_I16:
+      width = sizeof(uint16_t);
+      break;
+    case E_ARG_U32:
+    case E_ARG_I32:
+      width = sizeof(uint32_t);
+      break;
+    default:
+      break;
   }
-  if(ret == E_OK) {
-    ret = tobytes(buf, sizeof(int32_t), &tmp, sizeof(int32_t));
+  return width;
+}
+
+
+static inline uint8_t _arg_signed(ArgType_e argtype) {
+  return (argtype == E_ARG_I8) || (argtype == E_ARG_I16) || (argtype == E_ARG_I32);
+}
+
+/* Range check a value against its argument type and store it with the type
+   width. Values that do not fit leave the storage as is. */
+static inline ErrCode_e _store_num(ArgType_e argtype, int64_t val, uint8_t* data) {
+  ErrCode_e ret = E_OUT_OF_RANGE;
+  switch(argtype) {
+    case E_ARG_U8:
+      if((val >= 0) && (val <= UINT8_MAX)) {
+        _ARG_STORE(data, uint8_t, val);
+        ret = E_OK;
+      }
+      break;
+    case E_ARG_U16:
+      if((val >= 0) && (val <= UINT16_MAX)) {
+        _ARG_STORE(data, uint16_t, val);
+        ret = E_OK;
+      }
+      break;
+    case E_ARG_U32:
+      if((val >= 0) && (val <= UINT32_MAX)) {
+        _ARG_STORE(data, uint32_t, val);
+        ret = E_OK;
+      }
+      break;
+    case E_ARG_I8:
+      if((val >= INT8_MIN) && (val <= INT8_MAX)) {
+        _ARG_STORE(data, int8_t, val);
+        ret = E_OK;
+      }
+      break;
+    case E_ARG_I16:
+      if((val >= INT16_MIN) && (val <= INT16_MAX)) {
+        _ARG_STORE(data, int16_t, val);
+        ret = E_OK;
+      }
+      break;
+    case E_ARG_I32:
+      if((val >= INT32_MIN) && (val <= INT32_MAX)) {
+        _ARG_STORE(data, int32_t, val);
+        ret = E_OK;
+      }
+      break;
+    default:
+      /* String arguments are not supported yet. */
+      ret = E_NOT_IMPLEMENTED;
+      break;
   }
   return ret;
 }
 
-ErrCode_e _strtou32(const char* rawstr, void* buf) {
+/* Convert a numeric token straight into the argument storage. */
+STATIC ErrCode_e _convert_arg(const char* rawstr, size_t len, ArgType_e argtype, uint8_t* data) {
   ErrCode_e ret = E_GENERIC;
-  uint32_t tmp = 0;
-  if(rawstr && buf) {
-    ret = strtou32(rawstr, &tmp);
+  uint32_t u32 = 0;
+  int32_t i32 = 0;
+  int64_t val = 0;
+  if(!_arg_width(argtype)) {
+    ret = E_NOT_IMPLEMENTED;
+  } else if(_arg_signed(argtype)) {
+    ret = strntoi32(rawstr, len, &i32);
+    val = i32;
   } else {
-    ret = E_NULL_PTR;
+    ret = strntou32(rawstr, len, &u32);
+    val = u32;
   }
   if(ret == E_OK) {
-    ret = tobytes(buf, sizeof(uint32_t), &tmp, sizeof(uint32_t));
+    ret = _store_num(argtype, val, data);
   }
   return ret;
 }
 
-ErrCode_e _strtou8(const char* rawstr, void* buf) {
-  int32_t tmp;
-  ErrCode_e ret = _strtou32(rawstr, &tmp);
-  if((ret == E_OK) && (tmp >= 0) && (tmp <= UINT8_MAX)) {
-    ret = tobytes(buf, sizeof(uint8_t), &tmp, sizeof(uint8_t));
+/*****************************************************************************/
+
+/* Measure the token that starts at rawstr, in a single pass and without
+   copying it. The token ends at the next word break or at the end of the
+   string, in which case done is set. */
+STATIC ErrCode_e _get_param(const char* rawstr, size_t* len, uint8_t* done) {
+  size_t i = 0;
+  ErrCode_e ret = E_GENERIC;
+  if(rawstr && len && done) {
+    while((rawstr[i] != '\0') && (rawstr[i] != WrdBrkCh_c)) {
+      i++;
+    }
+    *done = (rawstr[i] == '\0');
+    *len = i;
+    /* No command found. */
+    ret = (i == 0) ? E_INV_SIZE : E_OK;
   } else {
-    ret = (ret != E_OK) ? E_OUT_OF_RANGE : ret;
+    ret = E_NULL_PTR;
   }
   return ret;
 }
 
-ErrCode_e _strtou16(const char* rawstr, void* buf) {
-  int32_t tmp;
-  ErrCode_e ret = _strtou32(rawstr, &tmp);
-  if((ret == E_OK) && (tmp >= 0) && (tmp <= UINT16_MAX)) {
-    ret = tobytes(buf, sizeof(uint16_t), &tmp, sizeof(uint16_t));
-  } else {
-    ret = (ret != E_OK) ? E_OUT_OF_RANGE : ret;
+/*****************************************************************************/
+/* Table accessors. **********************************************************/
+/*****************************************************************************/
+/* Commands are read by index, whatever the table format. A packed table is
+   read from its pools, at the offsets found when it was installed. */
+#if UCMD_PACKED
+#define _IS_PACKED(_table) ((_table)->packed != NULL)
+#else
+#define _IS_PACKED(_table) (0)
+#endif
+
+/* Name of a command. Names of a full table fill their whole array when they
+   are exactly UCMD_NAME_MAX_SIZE characters long, so the name helpers below
+   never read past that length. */
+static inline const char* _cmd_name(const uCmdTable_s* table, size_t idx) {
+#if UCMD_PACKED
+  if(_IS_PACKED(table)) {
+    return &table->packed->names[table->nameofs[idx]];
   }
-  return ret;
+#endif
+  return table->info_a[idx].cmdname;
 }
 
-ErrCode_e _strtoi8(const char* rawstr, void* buf) {
-  int32_t tmp;
-  ErrCode_e ret = _strtoi32(rawstr, &tmp);
-  if((ret == E_OK) && (tmp >= INT8_MIN) && (tmp <= INT8_MAX)) {
-    ret = tobytes(buf, sizeof(int8_t), &tmp, sizeof(int8_t));
-  } else {
-    ret = (ret != E_OK) ? E_OUT_OF_RANGE : ret;
+static inline CallbackPtr_t _cmd_handle(const uCmdTable_s* table, size_t idx) {
+#if UCMD_PACKED
+  if(_IS_PACKED(table)) {
+    return table->packed->cmd_a[idx].handle;
   }
-  return ret;
+#endif
+  return table->info_a[idx].handle;
 }
 
-ErrCode_e _strtoi16(const char* rawstr, void* buf) {
-  int32_t tmp;
-  ErrCode_e ret = _strtoi32(rawstr, &tmp);
-  if((ret == E_OK) && (tmp >= INT16_MIN) && (tmp <= INT16_MAX)) {
-    ret = tobytes(buf, sizeof(int16_t), &tmp, sizeof(int16_t));
-  } else {
-    ret = (ret != E_OK) ? E_OUT_OF_RANGE : ret;
+static inline void* _cmd_userarg(const uCmdTable_s* table, size_t idx) {
+#if UCMD_PACKED
+  if(_IS_PACKED(table)) {
+    return table->packed->cmd_a[idx].userarg;
   }
-  return ret;
+#endif
+  return table->info_a[idx].userarg;
 }
 
-static _strtonum_t* _strtonum_fp[] = {
-  _strtou8,
-  _strtou16,
-  _strtou32,
-  _strtoi8,
-  _strtoi16,
-  _strtoi32,
-};
+/* Argument descriptor k of a command, unused ones have no name. Packed
+   descriptors are expanded on the fly. */
+static inline ArgDesc_s _cmd_arg(const uCmdTable_s* table, size_t idx, size_t k) {
+#if UCMD_PACKED
+  ArgDesc_s desc = {E_ARG_NONE_TYPE, 0, 0, 0};
+  uCmdPackedArg_t parg;
+  if(_IS_PACKED(table)) {
+    if(k < table->packed->cmd_a[idx].argcnt) {
+      parg = table->packed->args[table->argofs[idx] + k];
+      desc.argtype = UCMD_PARG_TYPE(parg);
+      desc.argname = UCMD_PARG_NAME(parg);
+    }
+    return desc;
+  }
+#endif
+  return table->info_a[idx].argdesc[k];
+}
 
-typedef struct _strtonum {
-  _strtonum_t** _strtonum_fp;
-  size_t size;
-} _strtonum_s;
+/* Descriptor handed to callbacks in Arg_s.desc, NULL for a packed table. */
+static inline const ArgDesc_s* _cmd_argdesc(const uCmdTable_s* table, size_t idx, size_t k) {
+  return _IS_PACKED(table) ? NULL : &table->info_a[idx].argdesc[k];
+}
 
-static _strtonum_s _strtonum_h = {
-  _strtonum_fp,
-  6,
-};
+/* Copy the bound arguments given on the line to the user struct. Called once
+   the whole line is known to be right, so that a failed one leaves it alone. */
+static void _store_bound(const uCmdTable_s* table, size_t idx, const Arg_s* args, void* userarg) {
+  ArgDesc_s desc;
+  size_t i;
+  for(i = 0; i < UCMD_ARG_MAX_SIZE; i++) {
+    desc = _cmd_arg(table, idx, i);
+    if(desc.size && args[i].is_valid) {
+      memcpy((uint8_t*)userarg + desc.offset, args[i].data, desc.size);
+    }
+  }
+}
 
 /*****************************************************************************/
+/* Argument names. ***********************************************************/
+/*****************************************************************************/
+/* Bit of an argument name in uCmdArgIdx_s.mask, ARG_NAME_BIT_NONE if the
+   name is not in [0-9A-Za-z]. */
+static inline uint8_t _argname_bit(char argname) {
+  uint8_t bit = ARG_NAME_BIT_NONE;
+  if((argname >= '0') && (argname <= '9')) {
+    bit = (uint8_t)(argname - '0');
+  } else if((argname >= 'A') && (argname <= 'Z')) {
+    bit = (uint8_t)(argname - 'A' + 10);
+  } else if((argname >= 'a') && (argname <= 'z')) {
+    bit = (uint8_t)(argname - 'a' + 36);
+  }
+  return bit;
+}
+
+static inline uint8_t _popcount64(uint64_t val) {
+#if defined(__GNUC__)
+  return (uint8_t)__builtin_popcountll(val);
+#else
+  uint8_t cnt = 0;
+  for(; val; val &= val - 1) {
+    cnt++;
+  }
+  return cnt;
+#endif
+}
 
-STATIC ErrCode_e _get_param(const char* rawstr, char* param, uint8_t* done) {
-  int16_t i= 0;
+/* Check the argument descriptors of a command and index them by name. */
+STATIC ErrCode_e _build_argidx(const uCmdTable_s* table, size_t idx, uCmdArgIdx_s* argidx) {
   ErrCode_e ret = E_GENERIC;
-  if(rawstr && param && done) {
-    *done = 0;
-    ret = findch(rawstr, WrdBrkCh_c, &i);
-    if(i == -1) {
-      *done = 1;
-      i = (int16_t)strlen(rawstr);
-    }
-      /* No command found. */
-      if (i == 0) {
-         ret = E_INV_SIZE;
+  ArgDesc_s desc;
+  uint64_t bitmask;
+  uint8_t bit;
+  size_t i;
+  if(table && argidx) {
+    ret = E_OK;
+    argidx->mask = 0;
+    memset(argidx->slot, ARG_SLOT_NONE, sizeof(argidx->slot));
+    for(i = 0; (i < UCMD_ARG_MAX_SIZE) && (ret == E_OK); i++) {
+      desc = _cmd_arg(table, idx, i);
+      /* Unused descriptors have no name. */
+      if(desc.argname) {
+        bit = _argname_bit(desc.argname);
+        bitmask = (bit < ARG_NAME_BIT_NONE) ? ((uint64_t)1 << bit) : 0;
+        if(!bitmask || (argidx->mask & bitmask) || !_arg_width(desc.argtype)) {
+          ret = E_INV_ARG;
+        } else if(desc.size && (desc.size != _arg_width(desc.argtype))) {
+          ret = E_INV_SIZE;
+        } else {
+          argidx->mask |= bitmask;
+        }
       }
-      else if ((ret == E_OK) && i > 0) {
-         memcpy(param, rawstr, (size_t)i);
-         param[i] = '\0';
-         ret = E_OK;
+    }
+    /* Ranks are only known once every name is in the mask. */
+    for(i = 0; (i < UCMD_ARG_MAX_SIZE) && (ret == E_OK); i++) {
+      desc = _cmd_arg(table, idx, i);
+      if(desc.argname) {
+        bit = _argname_bit(desc.argname);
+        argidx->slot[_popcount64(argidx->mask & (((uint64_t)1 << bit) - 1))] = (uint8_t)i;
       }
+    }
   } else {
     ret = E_NULL_PTR;
   }
   return ret;
 }
 
-STATIC ErrCode_e _get_arg(const char* rawstr, const ArgDesc_s* argdesc_a, Arg_s* arg) {
+/* Descriptor index of an argument name, UCMD_ARG_MAX_SIZE if there is none. */
+static inline size_t _find_arg(const uCmdTable_s* table, size_t idx, char argname) {
+  const uCmdArgIdx_s* argidx;
+  size_t i = UCMD_ARG_MAX_SIZE;
+  uint8_t bit;
+  if(table->argidx) {
+    argidx = &table->argidx[idx];
+    bit = _argname_bit(argname);
+    if((bit < ARG_NAME_BIT_NONE) && ((argidx->mask >> bit) & 1u)) {
+      i = argidx->slot[_popcount64(argidx->mask & (((uint64_t)1 << bit) - 1))];
+    }
+  } else {
+    for(i = 0; (i < UCMD_ARG_MAX_SIZE) && (argname != _cmd_arg(table, idx, i).argname); i++) {}
+  }
+  return i;
+}
+
+/* Convert the argument token of command idx that starts at rawstr. */
+STATIC ErrCode_e _get_arg(const char* rawstr, size_t len, const uCmdTable_s* table, size_t idx, Arg_s* arg) {
   ErrCode_e ret = E_GENERIC;
-  const char* ofs = rawstr + 1;
-  char argname = rawstr[0];
+  ArgDesc_s desc;
   size_t i;
-  if(rawstr && argdesc_a && arg) {
-    ret = E_NOT_FOUND;
-    for(i = 0; (i < (UCMD_ARG_MAX_SIZE)) && (ret == E_NOT_FOUND); i++) {
-      if((argname == argdesc_a[i].argname) && (argdesc_a[i].argtype < (uint8_t)_strtonum_h.size)) {
-        arg[i].desc = &argdesc_a[i];
-        _strtonum_h._strtonum_fp[argdesc_a[i].argtype](ofs, &(arg[i].data));
-            arg[i].is_valid = 1;
-        ret = E_OK;
+  if(rawstr && len && table && arg) {
+    i = _find_arg(table, idx, rawstr[0]);
+    /* A value that cannot be converted fails the whole command. */
+    if(i >= UCMD_ARG_MAX_SIZE) {
+      ret = E_NOT_FOUND;
+    } else if((desc = _cmd_arg(table, idx, i)).size && !_cmd_userarg(table, idx)) {
+      ret = E_NULL_PTR;
+    } else if(desc.size && (desc.size != _arg_width(desc.argtype))) {
+      ret = E_INV_SIZE;
+    } else {
+      /* Bound arguments wait here too, the user struct is only written once
+         the whole line is known to be right. */
+      arg[i].desc = _cmd_argdesc(table, idx, i);
+      ret = _convert_arg(rawstr + 1, len - 1, desc.argtype, arg[i].data);
+      arg[i].is_valid = (ret == E_OK);
+    }
+  } else {
+    ret = (rawstr && table && arg) ? E_INV_SIZE : E_NULL_PTR;
+  }
+  return ret;
+}
+
+/*****************************************************************************/
+/* Perfect hash dispatch. ****************************************************/
+/*****************************************************************************/
+static inline size_t _name_len(const char* name) {
+  size_t len = 0;
+  while((len < UCMD_NAME_MAX_SIZE) && (name[len] != '\0')) {
+    len++;
+  }
+  return len;
+}
+
+static inline uint8_t _name_eq(const char* name, const char* str, size_t len) {
+  return (len <= UCMD_NAME_MAX_SIZE) && (strncmp(name, str, len) == 0) &&
+         ((len == UCMD_NAME_MAX_SIZE) || (name[len] == '\0'));
+}
+
+STATIC uint32_t _hash(const char* str, size_t len, uint32_t seed) {
+  uint32_t h = HASH_FNV_OFFSET ^ seed;
+  while(len--) {
+    h ^= (uint8_t)*str++;
+    h *= HASH_FNV_PRIME;
+  }
+  /* FNV leaves the high bits poorly mixed for short names. */
+  h ^= h >> 16;
+  h *= 0x7feb352du;
+  h ^= h >> 15;
+  return h;
+}
+
+/* Map a 32 bit hash onto [0, n) without a division. */
+static inline uint16_t _hash_reduce(uint32_t h, size_t n) {
+  return (uint16_t)(((uint64_t)h * n) >> 32);
+}
+
+STATIC ErrCode_e _build_hash(const uCmdTable_s* table, uCmdHash_s* hash) {
+  ErrCode_e ret = E_GENERIC;
+  uint16_t keys[UCMD_HASH_BUCKET_MAX_SIZE];
+  uint16_t slots[UCMD_HASH_BUCKET_MAX_SIZE];
+  size_t n;
+  size_t i;
+  size_t j;
+  size_t b;
+  size_t k;
+  size_t bsz;
+  size_t maxsz = 0;
+  uint16_t bucket;
+  uint32_t seed;
+
+  if(table && hash) {
+    n = table->size;
+    ret = ((n > 0) && (n <= UCMD_TABLE_MAX_SIZE)) ? E_OK : E_INV_SIZE;
+    /* Count how many names land on each first level bucket. */
+    memset(hash->seed, 0, sizeof(hash->seed));
+    for(i = 0; (i < n) && (ret == E_OK); i++) {
+      hash->slot[i] = UCMD_HASH_SLOT_EMPTY;
+      bucket = _hash_reduce(_hash(_cmd_name(table, i), _name_len(_cmd_name(table, i)), 0), n);
+      hash->seed[bucket]++;
+      maxsz = (hash->seed[bucket] > maxsz) ? hash->seed[bucket] : maxsz;
+    }
+    if(maxsz > UCMD_HASH_BUCKET_MAX_SIZE) {
+      ret = E_INTERNAL;
+    }
+
+    /* Place the largest buckets first, while most slots are still free. Each
+       bucket searches for a seed that sends all of its names to free slots. */
+    for(bsz = maxsz; (bsz > 1) && (ret == E_OK); bsz--) {
+      for(b = 0; (b < n) && (ret == E_OK); b++) {
+        if(hash->seed[b] != bsz) {
+          continue;
+        }
+        k = 0;
+        for(i = 0; i < n; i++) {
+          if(_hash_reduce(_hash(_cmd_name(table, i), _name_len(_cmd_name(table, i)), 0), n) == b) {
+            /* A duplicated name always shares the bucket of its first
+               occurrence. Keep the first one, as the linear scan would. */
+            for(j = 0; (j < k) && strncmp(_cmd_name(table, keys[j]), _cmd_name(table, i), UCMD_NAME_MAX_SIZE); j++) {}
+            if(j == k) {
+              keys[k++] = (uint16_t)i;
+            }
+          }
+        }
+        /* Seeds start above any bucket count so that placed buckets are
+           never mistaken for pending ones. */
+        for(seed = UCMD_HASH_BUCKET_MAX_SIZE + 1; seed < UCMD_HASH_SEED_DIRECT; seed++) {
+          for(i = 0; i < k; i++) {
+            slots[i] = _hash_reduce(_hash(_cmd_name(table, keys[i]), _name_len(_cmd_name(table, keys[i])), seed), n);
+            if(hash->slot[slots[i]] != UCMD_HASH_SLOT_EMPTY) {
+              break;
+            }
+            for(j = 0; (j < i) && (slots[j] != slots[i]); j++) {}
+            if(j < i) {
+              break;
+            }
+          }
+          if(i == k) {
+            break;
+          }
+        }
+        if(seed < UCMD_HASH_SEED_DIRECT) {
+          hash->seed[b] = (uint16_t)seed;
+          for(i = 0; i < k; i++) {
+            hash->slot[slots[i]] = keys[i];
+          }
+        } else {
+          ret = E_INTERNAL;
+        }
+      }
+    }
+
+    /* Single name buckets take any free slot directly. */
+    for(i = 0, j = 0; (i < n) && (ret == E_OK); i++) {
+      b = _hash_reduce(_hash(_cmd_name(table, i), _name_len(_cmd_name(table, i)), 0), n);
+      if(hash->seed[b] == 1) {
+        while(hash->slot[j] != UCMD_HASH_SLOT_EMPTY) {
+          j++;
+        }
+        hash->slot[j] = (uint16_t)i;
+        hash->seed[b] = (uint16_t)(UCMD_HASH_SEED_DIRECT | j);
       }
     }
   } else {
@@ -174,50 +528,82 @@ STATIC ErrCode_e _get_arg(const char* rawstr, const ArgDesc_s* argdesc_a, Arg_s*
   return ret;
 }
 
-STATIC ErrCode_e _get_cmdinfo(const char* cmdstr, const uCmdTable_s * cmd_table, const uCmdInfo_s** info) {
+/* Index of the only command that can match, cmd_table->size if none. */
+static size_t _hash_lookup(const char* cmdstr, size_t len, const uCmdTable_s* cmd_table) {
+  const uCmdHash_s* hash = cmd_table->hash;
+  size_t n = cmd_table->size;
+  uint16_t seed = hash->seed[_hash_reduce(_hash(cmdstr, len, 0), n)];
+  uint16_t slot;
+  uint16_t idx;
+  if(seed & UCMD_HASH_SEED_DIRECT) {
+    slot = seed & (uint16_t)~UCMD_HASH_SEED_DIRECT;
+  } else {
+    slot = _hash_reduce(_hash(cmdstr, len, seed), n);
+  }
+  idx = hash->slot[slot];
+  if((idx != UCMD_HASH_SLOT_EMPTY) && _name_eq(_cmd_name(cmd_table, idx), cmdstr, len)) {
+    return idx;
+  }
+  return n;
+}
+
+/*****************************************************************************/
+
+/* Index of the command named by the len characters at cmdstr. A name that
+   is not in the table gives cmd_table->size. */
+STATIC ErrCode_e _get_cmd(const char* cmdstr, size_t len, const uCmdTable_s * cmd_table, size_t* idx) {
   ErrCode_e ret = E_GENERIC;
-  uint8_t i;
+  size_t i;
   size_t table_sz;
-  const uCmdInfo_s* table_sa;
-  if(cmdstr && cmd_table && cmd_table->size && cmd_table->info_a && info) {
-    table_sa = cmd_table->info_a;
+  if(cmdstr && cmd_table && cmd_table->size && idx) {
     table_sz = cmd_table->size;
-    *info = NULL;
     ret = E_OK;
-    for(i = 0; i < table_sz; i++) {
-      if(strcmp(cmdstr, table_sa[i].cmdname) == 0) {
-        *info = &table_sa[i];
-            break;
-      }
+    if(cmd_table->hash) {
+      *idx = _hash_lookup(cmdstr, len, cmd_table);
+    } else {
+      for(i = 0; (i < table_sz) && !_name_eq(_cmd_name(cmd_table, i), cmdstr, len); i++) {}
+      *idx = i;
     }
   } else {
-    ret = (cmdstr && cmd_table && cmd_table->info_a && info) ? E_INV_SIZE : E_NULL_PTR;
+    ret = (cmdstr && cmd_table && idx) ? E_INV_SIZE : E_NULL_PTR;
   }
   return ret;
 }
 
 STATIC ErrCode_e _parse_string(const char* rawstr, const uCmdTable_s* table_sa, uCmdHandle_s* handle) {
   ErrCode_e ret = E_GENERIC;
-  char buf[UCMD_RAW_STR_MAX_SIZE] = {0};
-  char cmdname[UCMD_NAME_MAX_SIZE] = {0};
   uint8_t done = 0;
   const char* ofs = rawstr;
-  uint8_t argidx = 0;
-  const uCmdInfo_s* p_info_s;
-  uint8_t i;
+  size_t len = 0;
+  size_t idx = 0;
 
   if(rawstr && table_sa && table_sa->size && handle) {
-    memset(handle->args, 0, sizeof(Arg_s) * (UCMD_ARG_MAX_SIZE));
+    /* Get the command name from the raw string. Tokens are used in place,
+       as (pointer, length) pairs into the raw string. */
+    (void)_get_param(ofs, &len, &done);
 
-    /* Get the command name from the raw string. */
-    (void)_get_param(ofs, cmdname, &done);
-
-    /* Based on command name, get Info on it */
-    ret = _get_cmdinfo(cmdname, table_sa, &p_info_s);
-    ofs += strlen(cmdname) + 1;
-    if(!p_info_s) {
+    /* Based on command name, get its index in the table. */
+    ret = _get_cmd(ofs, len, table_sa, &idx);
+    /* A sub-table entry looks the next word up in its own table. */
+    while((ret == E_OK) && !done && (idx < table_sa->size) && (_cmd_handle(table_sa, idx) == uCmd_SubTable)) {
+      table_sa = &((const uCmdCtx_s*)_cmd_userarg(table_sa, idx))->table;
+      ofs += len + 1;
+      (void)_get_param(ofs, &len, &done);
+      ret = _get_cmd(ofs, len, table_sa, &idx);
+    }
+    ofs += len + 1;
+    if((ret != E_OK) || (idx >= table_sa->size) || !_cmd_handle(table_sa, idx) ||
+       (_cmd_handle(table_sa, idx) == uCmd_SubTable)) {
       ret = E_INTERNAL;
+      idx = table_sa->size;
     }
+#if UCMD_STATS || UCMD_TRACE
+    /* Failed lines are counted against their command, or as not found. */
+    handle->cmd = (uint16_t)idx;
+    handle->table = table_sa;
+#endif
+
+    memset(handle->args, 0, sizeof(Arg_s) * (UCMD_ARG_MAX_SIZE));
 
     if(ret == E_OK) {
       /* The flag done will already be set if there are no arguments
@@ -225,27 +611,22 @@ STATIC ErrCode_e _parse_string(const char* rawstr, const uCmdTable_s* table_sa,
          be exectued. */
       while((!done) &&
         /* Get argument string from raw string. */
-        ((ret = _get_param(ofs, buf, &done)) == E_OK) 
+        ((ret = _get_param(ofs, &len, &done)) == E_OK) 
         /* Fill-in the argument structure based on command name. 
            and argument string. */
-           && ((ret = _get_arg(buf, p_info_s->argdesc, handle->args)) == E_OK) 
+           && ((ret = _get_arg(ofs, len, table_sa, idx, handle->args)) == E_OK) 
       ) {
         /* Increase pointer to start of next argument if any. */
-        ofs += strlen(buf) + 1;
-        argidx++;
+        ofs += len + 1;
       }
     }
 
     if(ret == E_OK) {
-      /* Call command based on name and argument structure. */
-      // ret = _callback(table_sa, args_a);
-      for(i = 0; i < table_sa->size; i++) {
-        if(strcmp(table_sa->info_a[i].cmdname, cmdname) == 0) {
-          handle->callback = table_sa->info_a[i].handle;
-               handle->userarg = table_sa->info_a[i].userarg;
-          break;
-        }
-      }
+      /* The command was already resolved by the lookup above. */
+      handle->cmd = (uint16_t)idx;
+      handle->callback = _cmd_handle(table_sa, idx);
+      handle->userarg = _cmd_userarg(table_sa, idx);
+      _store_bound(table_sa, idx, handle->args, handle->userarg);
     }
   } else {
     ret = (rawstr && table_sa) ? E_INV_SIZE : E_NULL_PTR;
@@ -253,45 +634,1227 @@ STATIC ErrCode_e _parse_string(const char* rawstr, const uCmdTable_s* table_sa,
   return ret;
 }
 
-ErrCode_e uCmd_InitTable(const uCmdInfo_s* cmdtable, size_t table_sz) {
-   ErrCode_e ret = E_INV_ARG;
-   _cmdtable_p_s.info_a = NULL;
-   _cmdtable_p_s.size = 0;
-   if (cmdtable && table_sz) {
-      _cmdtable_p_s.info_a = cmdtable;
-      _cmdtable_p_s.size = table_sz;
-      ret = E_OK;
+#if UCMD_STREAM
+/* Character k of a command name, '\0' past its end. */
+static inline char _name_at(const char* name, size_t k) {
+  return (k < UCMD_NAME_MAX_SIZE) ? name[k] : '\0';
+}
+
+/* Sort the runnable commands by name, so that the character-level parser can
+   narrow the candidates as each character arrives. Insertion sort is stable,
+   a duplicated name resolves to its first entry as in the other lookups. */
+static void _build_order(const uCmdTable_s* table, uint16_t* order, uint16_t* ordercnt) {
+  uint16_t cnt = 0;
+  uint16_t idx, j;
+  for(idx = 0; idx < table->size; idx++) {
+    if(_cmd_handle(table, idx) && (_cmd_name(table, idx)[0] != '\0')) {
+      for(j = cnt; (j > 0) && (strncmp(_cmd_name(table, order[j - 1]),
+                                       _cmd_name(table, idx), UCMD_NAME_MAX_SIZE) > 0); j--) {
+        order[j] = order[j - 1];
+      }
+      order[j] = idx;
+      cnt++;
+    }
+  }
+  *ordercnt = cnt;
+}
+#endif
+
+static void _clear_table(uCmdCtx_s* ctx) {
+   ctx->table.info_a = NULL;
+   ctx->table.size = 0;
+   ctx->table.hash = NULL;
+   ctx->table.argidx = NULL;
+#if UCMD_PACKED
+   ctx->table.packed = NULL;
+   ctx->table.nameofs = ctx->nameofs;
+   ctx->table.argofs = ctx->argofs;
+#endif
+#if UCMD_STREAM
+   ctx->ordercnt = 0;
+#endif
+#if UCMD_STATS
+   ctx->table.stats = NULL;
+#endif
+#if UCMD_LATENCY
+   uCmdCtx_ResetLatency(ctx);
+#endif
+#if UCMD_TRACE
+   ctx->trace = NULL;
+#endif
+}
+
+/* Check every command of the table set in ctx and build the indexes over it.
+   A table that fails is not kept. */
+static ErrCode_e _index_table(uCmdCtx_s* ctx) {
+   ErrCode_e ret = E_OK;
+   size_t i;
+   /* Instances keep per command indexes, sized at build time. */
+   if (ctx->table.size > UCMD_TABLE_MAX_SIZE) {
+      ret = E_INV_SIZE;
+   }
+   for (i = 0; (i < ctx->table.size) && (ret == E_OK); i++) {
+      ret = _build_argidx(&ctx->table, i, &ctx->argidx[i]);
+      /* Sub-table entries take no argument, their next word is a name. */
+      if ((ret == E_OK) && (_cmd_handle(&ctx->table, i) == uCmd_SubTable) &&
+          (!_cmd_userarg(&ctx->table, i) || ctx->argidx[i].mask)) {
+         ret = E_INV_ARG;
+      }
+   }
+   if (ret != E_OK) {
+      _clear_table(ctx);
    }
    else {
-      ret = cmdtable ? E_INV_SIZE : E_NULL_PTR;
+      ctx->table.argidx = ctx->argidx;
+#if UCMD_STREAM
+      _build_order(&ctx->table, ctx->order, &ctx->ordercnt);
+#endif
+#if UCMD_HASH_DISPATCH
+      /* Tables that cannot be hashed keep working through the linear scan. */
+      if (_build_hash(&ctx->table, &ctx->hash) == E_OK) {
+         ctx->table.hash = &ctx->hash;
+      }
+#endif
    }
    return ret;
 }
 
-ErrCode_e uCmd_Run(const char* cmdstr) {
-   uCmdHandle_s handle;
+ErrCode_e uCmdCtx_InitTable(uCmdCtx_s* ctx, const uCmdInfo_s* cmdtable, size_t table_sz) {
    ErrCode_e ret = E_GENERIC;
-   if (_cmdtable_p_s.info_a && _cmdtable_p_s.size && cmdstr) {
-      ret = _parse_string(cmdstr, &_cmdtable_p_s, &handle);
+   if (ctx) {
+      _clear_table(ctx);
+   }
+   if (ctx && cmdtable && table_sz) {
+      ctx->table.info_a = cmdtable;
+      ctx->table.size = table_sz;
+      ret = _index_table(ctx);
+   }
+   else {
+      ret = (ctx && cmdtable) ? E_INV_SIZE : E_NULL_PTR;
+   }
+   return ret;
+}
+
+#if UCMD_PACKED
+/* The pools are walked once to find where each command starts in them. */
+ErrCode_e uCmdCtx_InitPacked(uCmdCtx_s* ctx, const uCmdPacked_s* table) {
+   ErrCode_e ret = E_GENERIC;
+   size_t nameofs = 0;
+   size_t argofs = 0;
+   size_t len;
+   size_t i;
+   if (ctx) {
+      _clear_table(ctx);
+   }
+   if (ctx && table && table->cmd_a && table->names && (table->args || !table->argsz) && table->size) {
+      ret = (table->size <= UCMD_TABLE_MAX_SIZE) ? E_OK : E_INV_SIZE;
+      for (i = 0; (i < table->size) && (ret == E_OK); i++) {
+         for (len = 0; (nameofs + len < table->namesz) && (table->names[nameofs + len] != '\0'); len++) {}
+         if (!len || (len > UCMD_NAME_MAX_SIZE) || (nameofs + len >= table->namesz) ||
+             (table->cmd_a[i].argcnt > UCMD_ARG_MAX_SIZE) ||
+             (argofs + table->cmd_a[i].argcnt > table->argsz)) {
+            ret = E_INV_SIZE;
+         }
+         else {
+            ctx->nameofs[i] = (uint16_t)nameofs;
+            ctx->argofs[i] = (uint16_t)argofs;
+            nameofs += len + 1;
+            argofs += table->cmd_a[i].argcnt;
+         }
+      }
+      /* Leftovers mean the pools do not match the command list. Only the
+         '\0' ending a string literal may remain. */
+      if ((ret == E_OK) && ((nameofs + 1 < table->namesz) || (argofs != table->argsz))) {
+         ret = E_INV_SIZE;
+      }
       if (ret == E_OK) {
-         ret = handle.callback(handle.args, handle.userarg);
+         ctx->table.packed = table;
+         ctx->table.size = table->size;
+         ret = _index_table(ctx);
       }
    }
    else {
-      ret = cmdstr ? E_NOT_INITIALIZED : E_NULL_PTR;
+      ret = (ctx && table && table->cmd_a && table->names) ? E_INV_SIZE : E_NULL_PTR;
    }
    return ret;
 }
+#endif
 
-ErrCode_e uCmd_Loop(void) {
-  char rawcmd[LINE_BUFF_SIZE] = {0};
-  ErrCode_e ret = E_OK;
-  uCMD_LOCK();
-  if(Line_IsCmplt()) {
-    Line_GetBuff((uint8_t*)rawcmd);
-    Line_FlushBuff();
-    ret = uCmd_Run(rawcmd);
-  }
-  uCMD_UNLOCK();
-  return ret;
+#if UCMD_REGISTRY
+ErrCode_e uCmdCtx_InitRegistered(uCmdCtx_s* ctx) {
+   ErrCode_e ret = E_GENERIC;
+   /* Addresses are compared as integers, the compiler would take two arrays
+      for distinct objects. */
+   size_t size = (size_t)((uintptr_t)__stop_ucmd_cmds - (uintptr_t)__start_ucmd_cmds) / sizeof(uCmdInfo_s);
+   size_t idx;
+   size_t i;
+   if (ctx && size) {
+      ret = uCmdCtx_InitTable(ctx, __start_ucmd_cmds, size);
+      /* Each name must resolve to its own entry, which a duplicate would not. */
+      for (i = 0; (i < size) && (ret == E_OK); i++) {
+         ret = _get_cmd(_cmd_name(&ctx->table, i), _name_len(_cmd_name(&ctx->table, i)), &ctx->table, &idx);
+         if ((ret == E_OK) && (idx != i)) {
+            ret = E_INV_ARG;
+         }
+      }
+      if (ret != E_OK) {
+         _clear_table(ctx);
+      }
+   }
+   else {
+      if (ctx) {
+         _clear_table(ctx);
+      }
+      ret = ctx ? E_INV_SIZE : E_NULL_PTR;
+   }
+   return ret;
+}
+#endif
+
+ErrCode_e uCmd_SubTable(Arg_s* args, void* usrargs) {
+   (void)args;
+   (void)usrargs;
+   return E_INTERNAL;
+}
+
+#if UCMD_CLOCK
+/* Ticks of the clock, 0 without one. */
+static inline uint32_t _clock_now(void) {
+   return _ucmd_clock ? _ucmd_clock() : 0u;
+}
+
+void uCmd_SetClock(uCmd_Clock clock) {
+   _ucmd_clock = clock;
+#if UCMD_LATENCY
+   Line_SetClock(clock);
+#endif
+}
+#endif
+
+#if UCMD_STATS
+/*****************************************************************************/
+/* Runtime statistics. *******************************************************/
+/*****************************************************************************/
+
+/* Number of significant bits of ticks, capped to the last bucket. */
+static inline uint8_t _stats_bucket(uint32_t ticks) {
+   uint8_t bits = 0;
+#if defined(__GNUC__)
+   bits = ticks ? (uint8_t)(8 * sizeof(unsigned long) - (size_t)__builtin_clzl(ticks)) : 0;
+#else
+   for (; ticks; ticks >>= 1) {
+      bits++;
+   }
+#endif
+   return (bits < UCMD_STATS_BUCKETS) ? bits : (UCMD_STATS_BUCKETS - 1);
+}
+
+/* Count one line run on table: its result, whether the callback was called,
+   and the parse and callback times that were taken. */
+static void _stats_record(const uCmdTable_s* table, size_t idx, ErrCode_e ret, uint8_t called,
+                          uint32_t parse, uint32_t call) {
+   uCmdStatsCmd_s* cmd;
+   if (table->stats) {
+      cmd = &table->stats->cmd[((idx < table->size) && (idx < UCMD_STATS_UNKNOWN)) ? idx : UCMD_STATS_UNKNOWN];
+      cmd->runs += called;
+      cmd->rets[(ret < E_LAST_ELEM) ? ret : E_GENERIC]++;
+      if (_ucmd_clock && (parse != STATS_UNTIMED)) {
+         cmd->parse[_stats_bucket(parse)]++;
+      }
+      if (_ucmd_clock && called) {
+         cmd->call[_stats_bucket(call)]++;
+      }
+   }
+}
+
+/* Queue " key=val", as the rest of the report, on the default Tx instance. */
+static ErrCode_e _stats_put(const char* key, uint32_t val) {
+   char buf[FMT_U32_MAX_LEN + 1];
+   const char* str_a[] = {" ", key, "=", buf};
+   (void)u32tostr(buf, sizeof(buf), val, NULL);
+   return Tx_WriteStr(str_a, sizeof(str_a) / sizeof(str_a[0]));
+}
+
+/* Non-zero counters of an array, as " index=count". */
+static ErrCode_e _stats_put_array(const char* name, const uint32_t* cnt_a, size_t cnt) {
+   char key[FMT_U32_MAX_LEN + 1];
+   ErrCode_e ret = Tx_WriteStr(&name, 1);
+   size_t i;
+   for (i = 0; (i < cnt) && (ret == E_OK); i++) {
+      if (cnt_a[i]) {
+         (void)u32tostr(key, sizeof(key), (uint32_t)i, NULL);
+         ret = _stats_put(key, cnt_a[i]);
+      }
+   }
+   return (ret == E_OK) ? Tx_Write("\n\r", 2) : ret;
+}
+
+/* Lines counted in a slot, whatever their result. */
+static inline uint32_t _stats_lines(const uCmdStatsCmd_s* cmd) {
+   uint32_t lines = 0;
+   size_t i;
+   for (i = 0; i < E_LAST_ELEM; i++) {
+      lines += cmd->rets[i];
+   }
+   return lines;
+}
+
+/* "name runs=N errs=N", then the details if asked. */
+static ErrCode_e _stats_put_cmd(const uCmdTable_s* table, size_t slot, uint8_t detail) {
+   const uCmdStatsCmd_s* cmd = &table->stats->cmd[slot];
+   const char* name = (slot < UCMD_STATS_UNKNOWN) ? _cmd_name(table, slot) : "?";
+   ErrCode_e ret = Tx_WriteStr(&name, 1);
+   if (ret == E_OK) {
+      ret = _stats_put("runs", cmd->runs);
+   }
+   if (ret == E_OK) {
+      ret = _stats_put("errs", _stats_lines(cmd) - cmd->rets[E_OK]);
+   }
+   if (ret == E_OK) {
+      ret = Tx_Write("\n\r", 2);
+   }
+   if ((ret == E_OK) && detail) {
+      ret = _stats_put_array(" ret", cmd->rets, E_LAST_ELEM);
+      if (ret == E_OK) {
+         ret = _stats_put_array(" parse", cmd->parse, UCMD_STATS_BUCKETS);
+      }
+      if (ret == E_OK) {
+         ret = _stats_put_array(" call", cmd->call, UCMD_STATS_BUCKETS);
+      }
+   }
+   return ret;
+}
+
+void uCmdStats_Init(uCmdStats_s* stats) {
+   if (stats) {
+      memset(stats, 0, sizeof(uCmdStats_s));
+   }
+}
+
+ErrCode_e uCmdCtx_SetStats(uCmdCtx_s* ctx, uCmdStats_s* stats) {
+   ErrCode_e ret = E_GENERIC;
+   if (ctx && ctx->table.size) {
+      ctx->table.stats = stats;
+      ret = E_OK;
+   }
+   else {
+      ret = ctx ? E_NOT_INITIALIZED : E_NULL_PTR;
+   }
+   return ret;
+}
+
+const uCmdStatsCmd_s* uCmdStats_GetCmd(const uCmdStats_s* stats, size_t idx) {
+   return stats ? &stats->cmd[(idx < UCMD_STATS_UNKNOWN) ? idx : UCMD_STATS_UNKNOWN] : NULL;
+}
+
+ErrCode_e uCmd_Stats(Arg_s* args, void* usrargs) {
+   const uCmdTable_s* table = usrargs ? &((const uCmdCtx_s*)usrargs)->table : &_ucmd_ctx.table;
+   size_t slot;
+   ErrCode_e ret = E_OK;
+   if (!table->stats) {
+      ret = E_NOT_INITIALIZED;
+   }
+   else if (UCMD_ARG_IS_VALID(args, 0)) {
+      slot = UCMD_ARG(args, 0, uint16_t);
+      slot = ((slot < table->size) && (slot < UCMD_STATS_UNKNOWN)) ? slot : UCMD_STATS_UNKNOWN;
+      ret = _stats_put_cmd(table, slot, 1);
+   }
+   else {
+      /* Commands never seen are left out. */
+      for (slot = 0; (slot <= UCMD_STATS_UNKNOWN) && (ret == E_OK); slot++) {
+         if (((slot < table->size) || (slot == UCMD_STATS_UNKNOWN)) && _stats_lines(&table->stats->cmd[slot])) {
+            ret = _stats_put_cmd(table, slot, 0);
+         }
+      }
+   }
+   return ret;
+}
+#endif
+
+#if UCMD_LATENCY
+/*****************************************************************************/
+/* Queueing latency. *********************************************************/
+/*****************************************************************************/
+/* Count the time since the completion of the line about to be called back. */
+static void _latency_record(uCmdCtx_s* ctx) {
+   uint32_t ticks;
+   if (ctx->stamped && _ucmd_clock) {
+      ticks = _ucmd_clock() - ctx->stamp;
+      ctx->latency.min = (ticks < ctx->latency.min) ? ticks : ctx->latency.min;
+      ctx->latency.max = (ticks > ctx->latency.max) ? ticks : ctx->latency.max;
+      ctx->latsum += ticks;
+      ctx->latency.cnt++;
+   }
 }
+
+void uCmdCtx_ResetLatency(uCmdCtx_s* ctx) {
+   if (ctx) {
+      ctx->latency.min = UINT32_MAX;
+      ctx->latency.max = 0;
+      ctx->latency.mean = 0;
+      ctx->latency.cnt = 0;
+      ctx->latsum = 0;
+      ctx->stamped = 0;
+   }
+}
+
+ErrCode_e uCmdCtx_GetLatency(const uCmdCtx_s* ctx, uCmdLatency_s* latency) {
+   ErrCode_e ret = E_GENERIC;
+   if (ctx && latency) {
+      memset(latency, 0, sizeof(uCmdLatency_s));
+      if (ctx->latency.cnt) {
+         *latency = ctx->latency;
+         latency->mean = (uint32_t)(ctx->latsum / ctx->latency.cnt);
+      }
+      ret = E_OK;
+   }
+   else {
+      ret = E_NULL_PTR;
+   }
+   return ret;
+}
+#endif
+
+#if UCMD_TRACE
+/*****************************************************************************/
+/* Flight recorder. **********************************************************/
+/*****************************************************************************/
+/* Record one line run on ctx. args is NULL if the arguments were not decoded
+   into the array, and the record then keeps none. */
+static void _trace_record(const uCmdCtx_s* ctx, const uCmdTable_s* table, size_t idx, const Arg_s* args,
+                          ErrCode_e ret) {
+   uCmdTraceRec_s* rec;
+   size_t i;
+   if (ctx->trace) {
+      rec = &ctx->trace->rec[ctx->trace->cnt % UCMD_TRACE_DEPTH];
+      rec->time = _clock_now();
+      rec->table = table;
+      rec->cmd = (uint16_t)((idx < table->size) ? idx : UCMD_TRACE_UNKNOWN);
+      rec->ret = (uint8_t)ret;
+      rec->valid = 0;
+      for (i = 0; args && (i < UCMD_TRACE_ARGS); i++) {
+         memcpy(rec->args[i], args[i].data, UCMD_ARG_BYTES_MAX_SIZE);
+         rec->valid |= (uint8_t)(args[i].is_valid << i);
+      }
+      ctx->trace->cnt++;
+   }
+}
+
+/* Indexes of the sub-table entries that lead from table down to sub, each one
+   followed by '.', written to buf. Only depth levels are searched. */
+static ErrCode_e _trace_path(const uCmdTable_s* table, const uCmdTable_s* sub, uint8_t depth, char* buf,
+                             size_t bufsz, size_t* len) {
+   ErrCode_e ret = (table == sub) ? E_OK : E_NOT_FOUND;
+   size_t numlen = 0;
+   size_t i;
+   *len = 0;
+   for (i = 0; (i < table->size) && (ret != E_OK) && depth; i++) {
+      if ((_cmd_handle(table, i) == uCmd_SubTable) &&
+          (u32tostr(buf, bufsz, (uint32_t)i, &numlen) == E_OK) && (numlen + 1 < bufsz)) {
+         buf[numlen] = '.';
+         ret = _trace_path(&((const uCmdCtx_s*)_cmd_userarg(table, i))->table, sub, depth - 1,
+                           &buf[numlen + 1], bufsz - numlen - 1, len);
+         *len += (ret == E_OK) ? numlen + 1 : 0;
+      }
+   }
+   return ret;
+}
+
+/* Queue one record of the instance table as a line on the default Tx instance. */
+static ErrCode_e _trace_put_rec(const uCmdTable_s* table, const uCmdTraceRec_s* rec) {
+   char path[TRACE_PATH_DEPTH * (FMT_U32_MAX_LEN + 1) + 1];
+   size_t pathlen = 0;
+   char num_a[3][FMT_U32_MAX_LEN + 1];
+   char hex_a[UCMD_TRACE_ARGS][FMT_HEX32_MAX_LEN + 1];
+   char idx_a[UCMD_TRACE_ARGS][2];
+   const char* str_a[7 + 4 * UCMD_TRACE_ARGS + 1];
+   size_t cnt = 0;
+   uint32_t data;
+   size_t i;
+   (void)u32tostr(num_a[0], sizeof(num_a[0]), rec->time, NULL);
+   (void)u32tostr(num_a[1], sizeof(num_a[1]), rec->cmd, NULL);
+   (void)u32tostr(num_a[2], sizeof(num_a[2]), rec->ret, NULL);
+   str_a[cnt++] = "t=";
+   str_a[cnt++] = num_a[0];
+   str_a[cnt++] = " c=";
+   /* Commands of sub-tables are given by their path from the instance table. */
+   if (_trace_path(table, rec->table, TRACE_PATH_DEPTH, path, sizeof(path), &pathlen) == E_OK) {
+      path[pathlen] = '\0';
+      str_a[cnt++] = path;
+   }
+   else {
+      str_a[cnt++] = "?.";
+   }
+   str_a[cnt++] = num_a[1];
+   str_a[cnt++] = " r=";
+   str_a[cnt++] = num_a[2];
+   for (i = 0; i < UCMD_TRACE_ARGS; i++) {
+      if (rec->valid & (1u << i)) {
+         data = 0;
+         memcpy(&data, rec->args[i], (UCMD_ARG_BYTES_MAX_SIZE < sizeof(data)) ? UCMD_ARG_BYTES_MAX_SIZE : sizeof(data));
+         (void)u32tohex(hex_a[i], sizeof(hex_a[i]), data, 0, NULL);
+         idx_a[i][0] = (char)('0' + i);
+         idx_a[i][1] = '\0';
+         str_a[cnt++] = " ";
+         str_a[cnt++] = idx_a[i];
+         str_a[cnt++] = "=";
+         str_a[cnt++] = hex_a[i];
+      }
+   }
+   str_a[cnt++] = "\n\r";
+   return Tx_WriteStr(str_a, cnt);
+}
+
+void uCmdTrace_Init(uCmdTrace_s* trace) {
+   if (trace) {
+      memset(trace, 0, sizeof(uCmdTrace_s));
+   }
+}
+
+ErrCode_e uCmdCtx_SetTrace(uCmdCtx_s* ctx, uCmdTrace_s* trace) {
+   ErrCode_e ret = E_GENERIC;
+   if (ctx && ctx->table.size) {
+      ctx->trace = trace;
+      ret = E_OK;
+   }
+   else {
+      ret = ctx ? E_NOT_INITIALIZED : E_NULL_PTR;
+   }
+   return ret;
+}
+
+const uCmdTraceRec_s* uCmdTrace_Get(const uCmdTrace_s* trace, size_t age) {
+   const uCmdTraceRec_s* rec = NULL;
+   if (trace && (age < trace->cnt) && (age < UCMD_TRACE_DEPTH)) {
+      rec = &trace->rec[(trace->cnt - 1u - age) % UCMD_TRACE_DEPTH];
+   }
+   return rec;
+}
+
+ErrCode_e uCmd_Trace(Arg_s* args, void* usrargs) {
+   const uCmdCtx_s* ctx = usrargs ? (const uCmdCtx_s*)usrargs : &_ucmd_ctx;
+   const uCmdTrace_s* trace = ctx->trace;
+   size_t age;
+   ErrCode_e ret = E_OK;
+   (void)args;
+   if (!trace) {
+      ret = E_NOT_INITIALIZED;
+   }
+   else {
+      /* The records kept, from the oldest one. */
+      age = (trace->cnt < UCMD_TRACE_DEPTH) ? trace->cnt : UCMD_TRACE_DEPTH;
+      for (; (age > 0) && (ret == E_OK); age--) {
+         ret = _trace_put_rec(&ctx->table, uCmdTrace_Get(trace, age - 1));
+      }
+   }
+   return ret;
+}
+#endif
+
+ErrCode_e uCmdCtx_Run(uCmdCtx_s* ctx, const char* cmdstr) {
+   uCmdHandle_s handle;
+   ErrCode_e ret = E_GENERIC;
+#if UCMD_STATS
+   uint32_t start = _clock_now();
+   uint32_t parsed = 0;
+#endif
+   if (ctx && ctx->table.size && cmdstr) {
+      ret = _parse_string(cmdstr, &ctx->table, &handle);
+#if UCMD_STATS
+      parsed = _clock_now();
+      if (ret != E_OK) {
+         _stats_record(handle.table, handle.cmd, ret, 0, parsed - start, 0);
+      }
+#endif
+      if (ret == E_OK) {
+#if UCMD_LATENCY
+         _latency_record(ctx);
+#endif
+         ret = handle.callback(handle.args, handle.userarg);
+#if UCMD_STATS
+         _stats_record(handle.table, handle.cmd, ret, 1, parsed - start, _clock_now() - parsed);
+#endif
+#if UCMD_TRACE
+         _trace_record(ctx, handle.table, handle.cmd, handle.args, ret);
+      }
+      else {
+         _trace_record(ctx, handle.table, handle.cmd, NULL, ret);
+#endif
+      }
+   }
+   else {
+      ret = (ctx && cmdstr) ? E_NOT_INITIALIZED : E_NULL_PTR;
+   }
+#if UCMD_LATENCY
+   /* The stamp only holds for the line uCmdCtx_Loop is running. */
+   if (ctx) {
+      ctx->stamped = 0;
+   }
+#endif
+   return ret;
+}
+
+ErrCode_e uCmdCtx_Loop(uCmdCtx_s* ctx, LineCtx_s* line) {
+  const char* rawcmd;
+  ErrCode_e ret = E_OK;
+  if (!line) {
+    ret = E_NULL_PTR;
+  } else {
+    /* The line is parsed in place, the receiver fills the other slots meanwhile.
+       Lines received meanwhile stay queued for the next calls. */
+    _LINE_LOCK();
+    rawcmd = (const char*)LineCtx_AcquireBuff(line);
+    _LINE_UNLOCK();
+    if(rawcmd) {
+#if UCMD_LATENCY
+      if (ctx) {
+        ctx->stamped = LineCtx_GetStamp(line, &ctx->stamp);
+      }
+#endif
+      ret = uCmdCtx_Run(ctx, rawcmd);
+      _LINE_LOCK();
+      LineCtx_ReleaseBuff(line);
+      _LINE_UNLOCK();
+    }
+  }
+  return ret;
+}
+
+#if UCMD_STREAM
+/*****************************************************************************/
+/* Character-level parser. ***************************************************/
+/*****************************************************************************/
+/* Slot of the line being received. Only the producer moves head. */
+static inline uCmdStreamCmd_s* _stream_cmd(uCmdStream_s* stream) {
+  return &stream->slot[LINE_IDX_LOAD(stream->head, relaxed) % UCMD_STREAM_QUEUE_DEPTH];
+}
+
+/* The first error of a line is kept, the rest of the line is ignored. */
+static inline void _stream_fail(uCmdStream_s* stream, ErrCode_e err) {
+  _stream_cmd(stream)->ret = err;
+  stream->state = STREAM_SKIP;
+}
+
+/* Keep the sorted names whose next character is ch. The candidates share
+   their first namelen characters, so they are also sorted on the next one
+   and both ends of the new range are found by binary search. */
+static void _stream_narrow(const uCmdCtx_s* ctx, uCmdStream_s* stream, char ch) {
+  const uCmdTable_s* table = &ctx->table;
+  uint16_t lo = stream->lo;
+  uint16_t hi = stream->hi;
+  uint16_t end, mid;
+  while(lo < hi) {
+    mid = lo + (hi - lo) / 2;
+    if((uint8_t)_name_at(_cmd_name(table, ctx->order[mid]), stream->namelen) < (uint8_t)ch) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  end = lo;
+  hi = stream->hi;
+  while(end < hi) {
+    mid = end + (hi - end) / 2;
+    if((uint8_t)_name_at(_cmd_name(table, ctx->order[mid]), stream->namelen) <= (uint8_t)ch) {
+      end = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  stream->lo = lo;
+  stream->hi = end;
+  stream->namelen++;
+}
+
+/* The name is complete: the first candidate matches if it is not longer. A
+   sub-table name leaves the parser on STREAM_NAME, in the sub-table. */
+static void _stream_resolve(const uCmdCtx_s* ctx, uCmdStream_s* stream) {
+  uCmdStreamCmd_s* cmd = _stream_cmd(stream);
+  uint16_t idx;
+  if((stream->lo < stream->hi) &&
+     (_name_len(_cmd_name(&ctx->table, ctx->order[stream->lo])) == stream->namelen)) {
+    idx = ctx->order[stream->lo];
+    if(_cmd_handle(&ctx->table, idx) == uCmd_SubTable) {
+      stream->level = (const uCmdCtx_s*)_cmd_userarg(&ctx->table, idx);
+#if UCMD_STATS || UCMD_TRACE
+      /* Names not found from here on are counted against the sub-table. */
+      cmd->table = &stream->level->table;
+      cmd->handle.cmd = (uint16_t)stream->level->table.size;
+#endif
+      stream->lo = 0;
+      stream->hi = stream->level->ordercnt;
+      stream->namelen = 0;
+    } else {
+      cmd->handle.cmd = idx;
+      cmd->handle.callback = _cmd_handle(&ctx->table, idx);
+      cmd->handle.userarg = _cmd_userarg(&ctx->table, idx);
+      cmd->table = &ctx->table;
+      stream->state = STREAM_ARG_START;
+    }
+  } else {
+    _stream_fail(stream, E_INTERNAL);
+  }
+}
+
+/* First character of an argument: its name. */
+static void _stream_arg_start(const uCmdCtx_s* ctx, uCmdStream_s* stream, char ch) {
+  const uCmdHandle_s* handle = &_stream_cmd(stream)->handle;
+  size_t i = _find_arg(&ctx->table, handle->cmd, ch);
+  if(i >= UCMD_ARG_MAX_SIZE) {
+    _stream_fail(stream, E_NOT_FOUND);
+  } else if(_cmd_arg(&ctx->table, handle->cmd, i).size && !handle->userarg) {
+    _stream_fail(stream, E_NULL_PTR);
+  } else {
+    stream->argslot = (uint8_t)i;
+    stream->neg = 0;
+    stream->digits = 0;
+    stream->acc = 0;
+    stream->state = STREAM_ARG_VALUE;
+  }
+}
+
+/* Digits are accumulated as they arrive. Past UINT32_MAX the magnitude is
+   saturated, it is out of range for every type anyway. */
+static void _stream_arg_char(const uCmdCtx_s* ctx, uCmdStream_s* stream, char ch) {
+  if((ch >= '0') && (ch <= '9')) {
+    stream->acc = stream->acc * 10 + (uint64_t)(ch - '0');
+    if(stream->acc > STREAM_ACC_SAT) {
+      stream->acc = STREAM_ACC_SAT;
+    }
+    stream->digits = 1;
+  } else if((ch == '-') && !stream->neg && !stream->digits &&
+            _arg_signed(_cmd_arg(&ctx->table, _stream_cmd(stream)->handle.cmd, stream->argslot).argtype)) {
+    stream->neg = 1;
+  } else {
+    _stream_fail(stream, E_OUT_OF_RANGE);
+  }
+}
+
+/* Range check and store the argument once its last digit is known. Bound
+   values also wait in the argument array: the user struct belongs to the
+   main loop and is only written at dispatch. */
+static void _stream_arg_end(const uCmdCtx_s* ctx, uCmdStream_s* stream) {
+  uCmdStreamCmd_s* cmd = _stream_cmd(stream);
+  ArgDesc_s desc = _cmd_arg(&ctx->table, cmd->handle.cmd, stream->argslot);
+  Arg_s* arg = &cmd->handle.args[stream->argslot];
+  int64_t val = stream->neg ? -(int64_t)stream->acc : (int64_t)stream->acc;
+  ErrCode_e ret = stream->digits ? _store_num(desc.argtype, val, arg->data) : E_INV_SIZE;
+  if(ret == E_OK) {
+    arg->desc = _cmd_argdesc(&ctx->table, cmd->handle.cmd, stream->argslot);
+    arg->is_valid = 1;
+    stream->state = STREAM_ARG_START;
+  } else {
+    _stream_fail(stream, ret);
+  }
+}
+
+/* Hand the line, resolved or failed, over to the consumer. */
+static inline void _stream_line_end(uCmdStream_s* stream) {
+  LINE_IDX_STORE(stream->head, (uint8_t)(LINE_IDX_LOAD(stream->head, relaxed) + 1u), release);
+  stream->state = STREAM_IDLE;
+}
+
+static void _stream_eol(const uCmdCtx_s* ctx, uCmdStream_s* stream) {
+  switch(stream->state) {
+    case STREAM_NAME:
+      _stream_resolve(ctx, stream);
+      if(stream->state == STREAM_NAME) {
+        /* The line ends on a sub-table name. */
+        _stream_fail(stream, E_INTERNAL);
+      }
+      _stream_line_end(stream);
+      break;
+    case STREAM_ARG_START:
+      /* Trailing word break, as an empty token in uCmd_Run. */
+      _stream_fail(stream, E_INV_SIZE);
+      _stream_line_end(stream);
+      break;
+    case STREAM_ARG_VALUE:
+      _stream_arg_end(ctx, stream);
+      _stream_line_end(stream);
+      break;
+    case STREAM_SKIP:
+      _stream_line_end(stream);
+      break;
+    default:
+      stream->state = STREAM_IDLE;
+      break;
+  }
+}
+
+static void _stream_brk(const uCmdCtx_s* ctx, uCmdStream_s* stream) {
+  switch(stream->state) {
+    case STREAM_NAME:
+      _stream_resolve(ctx, stream);
+      break;
+    case STREAM_ARG_START:
+      _stream_fail(stream, E_INV_SIZE);
+      break;
+    case STREAM_ARG_VALUE:
+      _stream_arg_end(ctx, stream);
+      break;
+    default:
+      /* Blanks before a line, or in one that is ignored. */
+      break;
+  }
+}
+
+static void _stream_ch(const uCmdCtx_s* ctx, uCmdStream_s* stream, char ch) {
+  uCmdStreamCmd_s* cmd;
+  switch(stream->state) {
+    case STREAM_IDLE:
+      /* A line that starts while the queue is full is dropped as a whole,
+         as in the Line queue. */
+      if((uint8_t)(LINE_IDX_LOAD(stream->head, relaxed) - LINE_IDX_LOAD(stream->tail, acquire)) >=
+         UCMD_STREAM_QUEUE_DEPTH) {
+        stream->drops++;
+        stream->state = STREAM_DROP;
+      } else {
+        cmd = _stream_cmd(stream);
+        memset(cmd->handle.args, 0, sizeof(cmd->handle.args));
+        cmd->ret = E_OK;
+#if UCMD_STATS || UCMD_TRACE
+        /* Counted as not found until the name is resolved. */
+        cmd->table = &ctx->table;
+        cmd->handle.cmd = (uint16_t)ctx->table.size;
+#endif
+        stream->lo = 0;
+        stream->hi = ctx->ordercnt;
+        stream->namelen = 0;
+        stream->state = STREAM_NAME;
+        _stream_narrow(ctx, stream, ch);
+      }
+      break;
+    case STREAM_NAME:
+      /* Once no name is left, the rest of it needs not be looked at. */
+      if(stream->lo < stream->hi) {
+        _stream_narrow(ctx, stream, ch);
+      }
+      break;
+    case STREAM_ARG_START:
+      _stream_arg_start(ctx, stream, ch);
+      break;
+    case STREAM_ARG_VALUE:
+      _stream_arg_char(ctx, stream, ch);
+      break;
+    default:
+      break;
+  }
+}
+
+void uCmdStream_Init(uCmdStream_s* stream) {
+  if(stream) {
+    LINE_IDX_STORE(stream->head, 0, relaxed);
+    LINE_IDX_STORE(stream->tail, 0, relaxed);
+    stream->drops = 0;
+    stream->level = NULL;
+    stream->state = STREAM_IDLE;
+  }
+}
+
+ErrCode_e uCmdCtx_StreamChar(const uCmdCtx_s* ctx, uCmdStream_s* stream, char ch) {
+  ErrCode_e ret = E_OK;
+  if(!ctx || !stream) {
+    ret = E_NULL_PTR;
+  } else if(!ctx->table.size) {
+    ret = E_NOT_INITIALIZED;
+  } else {
+    /* Lines start in ctx, sub-table names move them down a level. */
+    if(stream->state == STREAM_IDLE) {
+      stream->level = ctx;
+    }
+    if((ch == LINE_CHAR_LF) || (ch == LINE_CHAR_CR)) {
+      _stream_eol(stream->level, stream);
+    } else if(ch == WrdBrkCh_c) {
+      _stream_brk(stream->level, stream);
+    } else {
+      _stream_ch(stream->level, stream, ch);
+    }
+  }
+  return ret;
+}
+
+ErrCode_e uCmdCtx_StreamLoop(const uCmdCtx_s* ctx, uCmdStream_s* stream) {
+  uCmdStreamCmd_s* cmd = NULL;
+  uint8_t tail = 0;
+  ErrCode_e ret = E_OK;
+#if UCMD_STATS
+  uint32_t start;
+#endif
+  if(!ctx || !stream) {
+    ret = E_NULL_PTR;
+  } else if(!ctx->table.size) {
+    ret = E_NOT_INITIALIZED;
+  } else {
+    _LINE_LOCK();
+    tail = LINE_IDX_LOAD(stream->tail, relaxed);
+    if(tail != LINE_IDX_LOAD(stream->head, acquire)) {
+      cmd = &stream->slot[tail % UCMD_STREAM_QUEUE_DEPTH];
+    }
+    _LINE_UNLOCK();
+  }
+  if(cmd) {
+    ret = cmd->ret;
+    if(ret == E_OK) {
+      _store_bound(cmd->table, cmd->handle.cmd, cmd->handle.args, cmd->handle.userarg);
+#if UCMD_STATS
+      start = _clock_now();
+      ret = cmd->handle.callback(cmd->handle.args, cmd->handle.userarg);
+      /* Parsing was spread over the characters, it is not timed. */
+      _stats_record(cmd->table, cmd->handle.cmd, ret, 1, STATS_UNTIMED, _clock_now() - start);
+    } else {
+      _stats_record(cmd->table, cmd->handle.cmd, ret, 0, STATS_UNTIMED, 0);
+#else
+      ret = cmd->handle.callback(cmd->handle.args, cmd->handle.userarg);
+#endif
+    }
+#if UCMD_TRACE
+    /* Bound arguments are decoded into the array first, they are all kept. */
+    _trace_record(ctx, cmd->table, cmd->handle.cmd, (cmd->ret == E_OK) ? cmd->handle.args : NULL, ret);
+#endif
+    _LINE_LOCK();
+    LINE_IDX_STORE(stream->tail, (uint8_t)(tail + 1u), release);
+    _LINE_UNLOCK();
+  }
+  return ret;
+}
+
+uint16_t uCmdStream_GetDropCnt(const uCmdStream_s* stream) {
+  return stream ? stream->drops : 0;
+}
+#endif
+
+#if UCMD_FRAME
+/*****************************************************************************/
+/* Binary frames. ************************************************************/
+/*****************************************************************************/
+/* Store a little-endian argument at the width of its type. Signed types
+   keep the same bits, so no conversion is needed. */
+static inline void _frame_store(const uint8_t* src, size_t width, uint8_t* data) {
+  uint32_t val = 0;
+  size_t k;
+  for(k = width; k > 0; k--) {
+    val = (val << 8) | src[k - 1];
+  }
+  if(width == sizeof(uint8_t)) {
+    _ARG_STORE(data, uint8_t, val);
+  } else if(width == sizeof(uint16_t)) {
+    _ARG_STORE(data, uint16_t, val);
+  } else {
+    _ARG_STORE(data, uint32_t, val);
+  }
+}
+
+static inline uint8_t _frame_crc_ok(const uint8_t* frame) {
+  size_t end = UCMD_FRAME_HEAD_SIZE + frame[3];
+  uint16_t crc = crc16(CRC16_INIT, &frame[1], end - 1);
+  return (frame[end] == (uint8_t)crc) && (frame[end + 1] == (uint8_t)(crc >> 8));
+}
+
+/* Resolve a frame whose size and CRC are known to be right. The arguments
+   are checked against the descriptors before any of them is stored, so a
+   bound struct is left alone when the frame fails. */
+STATIC ErrCode_e _parse_frame(const uint8_t* frame, const uCmdTable_s* table, uCmdHandle_s* handle) {
+  ErrCode_e ret = E_OK;
+  const uint8_t* src = &frame[UCMD_FRAME_HEAD_SIZE];
+  size_t idx = (size_t)frame[1] | ((size_t)frame[2] << 8);
+  size_t len = frame[3];
+  size_t ofs = 0;
+  size_t cnt = 0;
+  ArgDesc_s desc;
+  void* userarg = NULL;
+  size_t i;
+
+  if((idx >= table->size) || !_cmd_handle(table, idx) || (_cmd_handle(table, idx) == uCmd_SubTable)) {
+    ret = E_INTERNAL;
+  } else {
+    userarg = _cmd_userarg(table, idx);
+    /* The arguments given must be the first ones of the list, whole. */
+    for(i = 0; (i < UCMD_ARG_MAX_SIZE) && (ofs < len) && (ret == E_OK); i++) {
+      desc = _cmd_arg(table, idx, i);
+      if(desc.argname) {
+        ofs += _arg_width(desc.argtype);
+        cnt = i + 1;
+        if(desc.size && !userarg) {
+          ret = E_NULL_PTR;
+        }
+      }
+    }
+    if((ret == E_OK) && (ofs != len)) {
+      ret = E_INV_SIZE;
+    }
+  }
+
+  memset(handle->args, 0, sizeof(Arg_s) * (UCMD_ARG_MAX_SIZE));
+
+  if(ret == E_OK) {
+    for(i = 0, ofs = 0; i < cnt; i++) {
+      desc = _cmd_arg(table, idx, i);
+      if(desc.argname) {
+        _frame_store(&src[ofs], _arg_width(desc.argtype), handle->args[i].data);
+        handle->args[i].desc = _cmd_argdesc(table, idx, i);
+        handle->args[i].is_valid = 1;
+      }
+      ofs += desc.argname ? _arg_width(desc.argtype) : 0;
+    }
+    handle->cmd = (uint16_t)idx;
+    handle->callback = _cmd_handle(table, idx);
+    handle->userarg = userarg;
+    _store_bound(table, idx, handle->args, userarg);
+  }
+  return ret;
+}
+
+static ErrCode_e _run_frame(const uCmdCtx_s* ctx, const uint8_t* frame) {
+  uCmdHandle_s handle;
+#if UCMD_STATS || UCMD_TRACE
+  size_t idx = (size_t)frame[1] | ((size_t)frame[2] << 8);
+#endif
+#if UCMD_STATS
+  uint32_t start = _clock_now();
+  uint32_t parsed;
+#endif
+  ErrCode_e ret = _parse_frame(frame, &ctx->table, &handle);
+#if UCMD_STATS
+  parsed = _clock_now();
+  if(ret != E_OK) {
+    _stats_record(&ctx->table, idx, ret, 0, parsed - start, 0);
+  }
+#endif
+  if(ret == E_OK) {
+    ret = handle.callback(handle.args, handle.userarg);
+#if UCMD_STATS
+    _stats_record(&ctx->table, idx, ret, 1, parsed - start, _clock_now() - parsed);
+#endif
+#if UCMD_TRACE
+    _trace_record(ctx, &ctx->table, idx, handle.args, ret);
+  } else {
+    _trace_record(ctx, &ctx->table, idx, NULL, ret);
+#endif
+  }
+  return ret;
+}
+
+ErrCode_e uCmdCtx_RunFrame(const uCmdCtx_s* ctx, const uint8_t* frame, size_t frame_sz) {
+  ErrCode_e ret = E_GENERIC;
+  if(!ctx || !frame) {
+    ret = E_NULL_PTR;
+  } else if(!ctx->table.size) {
+    ret = E_NOT_INITIALIZED;
+  } else if((frame_sz < UCMD_FRAME_HEAD_SIZE + UCMD_FRAME_CRC_SIZE) || (frame[3] > UCMD_FRAME_ARGS_MAX_SIZE) ||
+            (frame_sz != (size_t)UCMD_FRAME_HEAD_SIZE + frame[3] + UCMD_FRAME_CRC_SIZE)) {
+    ret = E_INV_SIZE;
+  } else if((frame[0] != UCMD_FRAME_SYNC) || !_frame_crc_ok(frame)) {
+    ret = E_INV_ARG;
+  } else {
+    ret = _run_frame(ctx, frame);
+  }
+  return ret;
+}
+
+void uCmdFrame_Init(uCmdFrame_s* frame) {
+  if(frame) {
+    LINE_IDX_STORE(frame->head, 0, relaxed);
+    LINE_IDX_STORE(frame->tail, 0, relaxed);
+    frame->drops = 0;
+    frame->errs = 0;
+    frame->cnt = 0;
+  }
+}
+
+void uCmdFrame_AddByte(uCmdFrame_s* frame, uint8_t byte) {
+  uint8_t head;
+  if(frame) {
+    head = LINE_IDX_LOAD(frame->head, relaxed);
+    if(frame->cnt == 0) {
+      /* Bytes between frames are skipped. A frame that starts while the queue
+         is full is followed to its end without being stored, as in the Line
+         queue, so that its bytes are not taken for the next sync. */
+      if(byte == UCMD_FRAME_SYNC) {
+        frame->skip = ((uint8_t)(head - LINE_IDX_LOAD(frame->tail, acquire)) >= UCMD_FRAME_QUEUE_DEPTH);
+        frame->buff[head % UCMD_FRAME_QUEUE_DEPTH][0] = byte;
+        frame->cnt = 1;
+      }
+    } else {
+      if(!frame->skip) {
+        frame->buff[head % UCMD_FRAME_QUEUE_DEPTH][frame->cnt] = byte;
+      }
+      if(frame->cnt == UCMD_FRAME_HEAD_SIZE - 1) {
+        frame->len = byte;
+      }
+      frame->cnt++;
+      if((frame->cnt == UCMD_FRAME_HEAD_SIZE) && (frame->len > UCMD_FRAME_ARGS_MAX_SIZE)) {
+        frame->errs++;
+        frame->cnt = 0;
+      } else if(frame->cnt == UCMD_FRAME_HEAD_SIZE + frame->len + UCMD_FRAME_CRC_SIZE) {
+        if(frame->skip) {
+          frame->drops++;
+        } else if(_frame_crc_ok(frame->buff[head % UCMD_FRAME_QUEUE_DEPTH])) {
+          LINE_IDX_STORE(frame->head, (uint8_t)(head + 1u), release);
+        } else {
+          frame->errs++;
+        }
+        frame->cnt = 0;
+      }
+    }
+  }
+}
+
+ErrCode_e uCmdCtx_FrameLoop(const uCmdCtx_s* ctx, uCmdFrame_s* frame) {
+  const uint8_t* buff = NULL;
+  uint8_t tail = 0;
+  ErrCode_e ret = E_OK;
+  if(!ctx || !frame) {
+    ret = E_NULL_PTR;
+  } else if(!ctx->table.size) {
+    ret = E_NOT_INITIALIZED;
+  } else {
+    _LINE_LOCK();
+    tail = LINE_IDX_LOAD(frame->tail, relaxed);
+    if(tail != LINE_IDX_LOAD(frame->head, acquire)) {
+      buff = frame->buff[tail % UCMD_FRAME_QUEUE_DEPTH];
+    }
+    _LINE_UNLOCK();
+  }
+  if(buff) {
+    ret = _run_frame(ctx, buff);
+    _LINE_LOCK();
+    LINE_IDX_STORE(frame->tail, (uint8_t)(tail + 1u), release);
+    _LINE_UNLOCK();
+  }
+  return ret;
+}
+
+uint16_t uCmdFrame_GetDropCnt(const uCmdFrame_s* frame) {
+  return frame ? frame->drops : 0;
+}
+
+uint16_t uCmdFrame_GetErrCnt(const uCmdFrame_s* frame) {
+  return frame ? frame->errs : 0;
+}
+
+ErrCode_e uCmdFrame_Encode(uint8_t* buf, size_t buf_sz, uint16_t cmd, const uint8_t* args, size_t args_sz,
+                           size_t* frame_sz) {
+  ErrCode_e ret = E_GENERIC;
+  size_t end = UCMD_FRAME_HEAD_SIZE + args_sz;
+  uint16_t crc;
+  if(buf && frame_sz && (args || !args_sz) && (args_sz <= UCMD_FRAME_ARGS_MAX_SIZE) &&
+     (buf_sz >= end + UCMD_FRAME_CRC_SIZE)) {
+    buf[0] = UCMD_FRAME_SYNC;
+    buf[1] = (uint8_t)cmd;
+    buf[2] = (uint8_t)(cmd >> 8);
+    buf[3] = (uint8_t)args_sz;
+    if(args_sz) {
+      memcpy(&buf[UCMD_FRAME_HEAD_SIZE], args, args_sz);
+    }
+    crc = crc16(CRC16_INIT, &buf[1], end - 1);
+    buf[end] = (uint8_t)crc;
+    buf[end + 1] = (uint8_t)(crc >> 8);
+    *frame_sz = end + UCMD_FRAME_CRC_SIZE;
+    ret = E_OK;
+  } else {
+    ret = (buf && frame_sz && (args || !args_sz)) ? E_INV_SIZE : E_NULL_PTR;
+  }
+  return ret;
+}
+#endif
+
+ErrCode_e uCmd_InitTable(const uCmdInfo_s* cmdtable, size_t table_sz) {
+#if UCMD_STREAM
+   uCmdStream_Init(&_ucmd_stream);
+#endif
+#if UCMD_FRAME
+   uCmdFrame_Init(&_ucmd_frame);
+#endif
+   return uCmdCtx_InitTable(&_ucmd_ctx, cmdtable, table_sz);
+}
+
+#if UCMD_PACKED
+ErrCode_e uCmd_InitPacked(const uCmdPacked_s* table) {
+#if UCMD_STREAM
+   uCmdStream_Init(&_ucmd_stream);
+#endif
+#if UCMD_FRAME
+   uCmdFrame_Init(&_ucmd_frame);
+#endif
+   return uCmdCtx_InitPacked(&_ucmd_ctx, table);
+}
+#endif
+
+#if UCMD_REGISTRY
+ErrCode_e uCmd_InitRegistered(void) {
+#if UCMD_STREAM
+   uCmdStream_Init(&_ucmd_stream);
+#endif
+#if UCMD_FRAME
+   uCmdFrame_Init(&_ucmd_frame);
+#endif
+   return uCmdCtx_InitRegistered(&_ucmd_ctx);
+}
+#endif
+
+ErrCode_e uCmd_Run(const char* cmdstr) {
+   return uCmdCtx_Run(&_ucmd_ctx, cmdstr);
+}
+
+ErrCode_e uCmd_Loop(void) {
+  return uCmdCtx_Loop(&_ucmd_ctx, Line_GetCtx());
+}
+
+#if UCMD_FRAME
+ErrCode_e uCmd_RunFrame(const uint8_t* frame, size_t frame_sz) {
+  return uCmdCtx_RunFrame(&_ucmd_ctx, frame, frame_sz);
+}
+
+void uCmd_FrameByte(uint8_t byte) {
+  uCmdFrame_AddByte(&_ucmd_frame, byte);
+}
+
+ErrCode_e uCmd_FrameLoop(void) {
+  return uCmdCtx_FrameLoop(&_ucmd_ctx, &_ucmd_frame);
+}
+
+uint16_t uCmd_GetFrameDropCnt(void) {
+  return uCmdFrame_GetDropCnt(&_ucmd_frame);
+}
+
+uint16_t uCmd_GetFrameErrCnt(void) {
+  return uCmdFrame_GetErrCnt(&_ucmd_frame);
+}
+#endif
+
+#if UCMD_STREAM
+ErrCode_e uCmd_StreamChar(char ch) {
+  return uCmdCtx_StreamChar(&_ucmd_ctx, &_ucmd_stream, ch);
+}
+
+ErrCode_e uCmd_StreamLoop(void) {
+  return uCmdCtx_StreamLoop(&_ucmd_ctx, &_ucmd_stream);
+}
+
+uint16_t uCmd_GetStreamDropCnt(void) {
+  return uCmdStream_GetDropCnt(&_ucmd_stream);
+}
+#endif
+
+#if UCMD_STATS
+ErrCode_e uCmd_SetStats(uCmdStats_s* stats) {
+  return uCmdCtx_SetStats(&_ucmd_ctx, stats);
+}
+#endif
+
+#if UCMD_LATENCY
+ErrCode_e uCmd_GetLatency(uCmdLatency_s* latency) {
+  return uCmdCtx_GetLatency(&_ucmd_ctx, latency);
+}
+
+void uCmd_ResetLatency(void) {
+  uCmdCtx_ResetLatency(&_ucmd_ctx);
+}
+#endif
+
+#if UCMD_TRACE
+ErrCode_e uCmd_SetTrace(uCmdTrace_s* trace) {
+  return uCmdCtx_SetTrace(&_ucmd_ctx, trace);
+}
+#endif
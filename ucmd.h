@@ -2,22 +2,34 @@
 #define UCMD_H
 
 #include "err.h"
+#include "ucmd_config.h"
+#include "line.h"
+#include <stddef.h>
 #include <stdint.h>
 
 #define UCMD_ARG_BYTES_MAX_SIZE (4) // Maximum number of bytes that arguments take.
 #define UCMD_DATA_TYPE_BYTES_MAX_SIZE (UCMD_ARG_BYTES_MAX_SIZE)
-#define UCMD_TABLE_MAX_SIZE (8) // Maximum number of callbacks.
-#define UCMD_ARG_MAX_SIZE (4) // Maximum number of arguments per command.
-#define UCMD_NAME_MAX_SIZE (16) // Maximum string length of callback name.
-#define UCMD_RAW_STR_MAX_SIZE (64) // Max. size of buffer that holds raw data.
+#define UCMD_HASH_SLOT_EMPTY (0xFFFF)
+#define UCMD_HASH_SEED_DIRECT (0x8000) // Seed holds the slot index itself.
 
 #define UCMD_ARG(_args, _idx, _type) (_type)(*(((_type*)(&(_args)[(_idx)].data))))
 #define UCMD_ARG_IS_VALID(_args, _idx) ((_args)[(_idx)].is_valid)
-#define UCMD_ARG_NONE {{E_ARG_NONE_TYPE, 0}}
+/* Argument passed to the callback in the Arg_s array. */
+#define UCMD_ARG_DESC(_argtype, _argname) {(_argtype), (_argname), 0, 0}
+/* Argument decoded straight into _member of the _struct passed as userarg. */
+#define UCMD_ARG_BIND(_argtype, _argname, _struct, _member) \
+  {(_argtype), (_argname), (uint16_t)offsetof(_struct, _member), (uint8_t)sizeof(((_struct*)0)->_member)}
+#define UCMD_ARG_NONE {{E_ARG_NONE_TYPE, 0, 0, 0}}
 #define UCMD_ARG_USER_NONE NULL
 #define UCMD_CALLBACK_NONE NULL
 #define UCMD_TABLE_END {"", UCMD_CALLBACK_NONE, UCMD_ARG_NONE, UCMD_ARG_USER_NONE}
 
+/* Entry that hands the rest of the line to the table installed in _subctx, a
+ * uCmdCtx_s, so that "motor 1 pwm f2000" walks three tables before reaching
+ * the command. Each level is looked up through its own index, and sub-tables
+ * may be installed by the modules that own them, in any order. */
+#define UCMD_SUBTABLE(_cmdname, _subctx) {(_cmdname), uCmd_SubTable, UCMD_ARG_NONE, (_subctx)}
+
 #define UCMD_GET_TABLE_SIZE(x) (sizeof((x)) / sizeof(uCmdInfo_s))
 
 typedef enum ArgType {
@@ -32,9 +44,20 @@ typedef enum ArgType {
   E_ARG_INV_TYPE = 255,
 } ArgType_e;
 
+/* Arguments with a size are bound: they are written to offset bytes into the
+ * command userarg, which must then point to a struct, and size must match the
+ * argument type. Bound arguments that are not given keep their value, and
+ * none is written unless the whole line is right. Unbound arguments (size 0)
+ * are passed to the callback in the Arg_s array. The array is cleared for each
+ * line and bound arguments are in it as well, so that it only ever holds the
+ * values of the line being run.
+ * Descriptors are written with UCMD_ARG_DESC or UCMD_ARG_BIND, which give
+ * every field. */
 typedef struct ArgDesc {
   ArgType_e argtype;
   char argname;
+  uint16_t offset;
+  uint8_t size;
 } ArgDesc_s;
 
 typedef struct Arg {
@@ -54,21 +77,424 @@ typedef struct uCmdInfo {
   void* userarg;
 } uCmdInfo_s;
 
+#if UCMD_REGISTRY
+/* Command declared next to its callback, in any source file. Entries land in
+ * the ucmd_cmds section and uCmd_InitRegistered installs them all as one table.
+ * The name is given as an identifier, arguments come last, none if it has none:
+ *
+ *   UCMD_REGISTER(led, led_cb, UCMD_ARG_USER_NONE,
+ *                 UCMD_ARG_DESC(E_ARG_U8, 'n'), UCMD_ARG_DESC(E_ARG_U8, 'd'));
+ *   UCMD_REGISTER(reset, reset_cb, UCMD_ARG_USER_NONE);
+ *
+ * Linking with --gc-sections needs KEEP(*(ucmd_cmds)) in the linker script.
+ * The alignment is given so that the compiler cannot pad entries apart. */
+#define UCMD_REGISTER(_name, _handle, _userarg, ...) \
+  static const uCmdInfo_s _ucmd_reg_##_name \
+  __attribute__((used, section("ucmd_cmds"), aligned(__alignof__(uCmdInfo_s)))) = \
+  {#_name, (_handle), {__VA_ARGS__}, (_userarg)}
+#endif
+
+#if UCMD_PACKED
+/* Packed command table, meant for flash. Names are pooled in one string, each
+ * one ended by '\0', and argument descriptors in one byte array, each command
+ * taking the next argcnt of them. Commands, names and arguments are listed in
+ * the same order. A descriptor is a single byte: the argument type in the upper
+ * 3 bits and its name, a lower case letter, in the lower 5. Any other name is
+ * packed as '`', which uCmd_InitPacked() rejects with E_INV_ARG. Packed
+ * arguments cannot be bound, and their Arg_s.desc is NULL.
+ *
+ *   static const char names[] = "led\0" "pwm\0";
+ *   static const uCmdPackedArg_t args[] = {
+ *     UCMD_PARG(E_ARG_U8, 'n'),
+ *     UCMD_PARG(E_ARG_U16, 'f'), UCMD_PARG(E_ARG_U8, 'd'),
+ *   };
+ *   static const uCmdPackedCmd_s cmds[] = {{led_cb, NULL, 1}, {pwm_cb, NULL, 2}};
+ *   static const uCmdPacked_s table = UCMD_PACKED_TABLE(cmds, names, args);
+ */
+typedef uint8_t uCmdPackedArg_t;
+#define UCMD_PARG(_argtype, _argname) ((uCmdPackedArg_t)(((_argtype) << 5) | \
+  ((((_argname) >= 'a') && ((_argname) <= 'z')) ? ((_argname) & 0x1F) : 0)))
+#define UCMD_PARG_TYPE(_parg) ((ArgType_e)((_parg) >> 5))
+#define UCMD_PARG_NAME(_parg) ((char)(0x60 | ((_parg) & 0x1F)))
+
+typedef struct uCmdPackedCmd {
+  CallbackPtr_t handle;
+  void* userarg;
+  uint8_t argcnt;
+} uCmdPackedCmd_s;
+
+typedef struct uCmdPacked {
+  const uCmdPackedCmd_s* cmd_a;
+  const char* names;
+  const uCmdPackedArg_t* args;
+  uint16_t size; /* Number of commands. */
+  uint16_t namesz; /* Bytes in names. The '\0' ending a string literal may be counted. */
+  uint16_t argsz; /* Descriptors in args. */
+} uCmdPacked_s;
+
+#define UCMD_PACKED_TABLE(_cmd_a, _names, _args) \
+  {(_cmd_a), (_names), (_args), (uint16_t)(sizeof(_cmd_a) / sizeof((_cmd_a)[0])), \
+   (uint16_t)sizeof(_names), (uint16_t)(sizeof(_args) / sizeof((_args)[0]))}
+#endif
+
+/* Minimal perfect hash over the command names of a table. A name is mapped
+ * to a first level bucket, whose seed selects the final slot. Each slot holds
+ * the index of the only command that can match, so a lookup costs two hashes
+ * and a single string compare regardless of the table size. */
+typedef struct uCmdHash {
+  uint16_t seed[UCMD_TABLE_MAX_SIZE];
+  uint16_t slot[UCMD_TABLE_MAX_SIZE];
+} uCmdHash_s;
+
+/* Argument names of one command, checked once by uCmd_InitTable. Each name
+ * in [0-9A-Za-z] has a bit in mask; the number of set bits below it gives its
+ * rank, and slot maps the rank back to the descriptor index. */
+typedef struct uCmdArgIdx {
+  uint64_t mask;
+  uint8_t slot[UCMD_ARG_MAX_SIZE];
+} uCmdArgIdx_s;
+
+#if UCMD_CLOCK
+/* Free running tick counter, such as DWT CYCCNT. It may wrap around. */
+typedef uint32_t (*uCmd_Clock)(void);
+#endif
+
+#if UCMD_STATS
+#define UCMD_STATS_UNKNOWN (UCMD_TABLE_MAX_SIZE) // Slot of the names not found.
+#define UCMD_STATS_NAME "stats"
+/* Built-in command that reports the statistics of the instance _ctx, the default
+ * one if NULL. Without argument it lists every command seen, with c<index> it
+ * adds the results and time histograms of that command. */
+#define UCMD_STATS_CMD(_ctx) {UCMD_STATS_NAME, uCmd_Stats, {UCMD_ARG_DESC(E_ARG_U16, 'c')}, (_ctx)}
+
+/* Counters of one command. Time bucket k counts the times of k significant bits,
+ * [2^(k-1), 2^k) ticks, and bucket 0 the times of 0 ticks. */
+typedef struct uCmdStatsCmd {
+  uint32_t runs; /* Callback calls. */
+  uint32_t rets[E_LAST_ELEM]; /* Lines by result, E_OK included. */
+  uint32_t parse[UCMD_STATS_BUCKETS]; /* Parse times, for the lines run with uCmd_Run or as frames. */
+  uint32_t call[UCMD_STATS_BUCKETS]; /* Callback times. */
+} uCmdStatsCmd_s;
+
+/* Counters of one instance, indexed as its table. Storage is provided by the
+ * caller, see uCmd_SetStats. Only the main loop writes them. */
+typedef struct uCmdStats {
+  uCmdStatsCmd_s cmd[UCMD_TABLE_MAX_SIZE + 1];
+} uCmdStats_s;
+#endif
+
+#if UCMD_LATENCY
+/* Ticks from the completion of a line, in the receiving context, to the start
+ * of its callback: the time spent queued plus the parse time. */
+typedef struct uCmdLatency {
+  uint32_t min;
+  uint32_t max;
+  uint32_t mean;
+  uint32_t cnt; /* Callbacks measured. */
+} uCmdLatency_s;
+#endif
+
+#if UCMD_TRACE
+#define UCMD_TRACE_UNKNOWN (0xFFFF) // Command index of the names not found.
+#define UCMD_TRACE_NAME "trace"
+/* Built-in command that writes the trace of the instance _ctx, the default one
+ * if NULL, oldest command first. */
+#define UCMD_TRACE_CMD(_ctx) {UCMD_TRACE_NAME, uCmd_Trace, UCMD_ARG_NONE, (_ctx)}
+
+/* One command run. Arguments are kept as decoded, in the layout of Arg_s data;
+ * those of commands that bind all their arguments are not kept. */
+typedef struct uCmdTraceRec {
+  uint32_t time; /* Clock ticks when the command returned, 0 without a clock. */
+  const struct uCmdTable* table; /* Table the name was looked up in, a sub-table for nested commands. */
+  uint16_t cmd; /* Index in table, UCMD_TRACE_UNKNOWN if the name was not found there. */
+  uint8_t ret; /* ErrCode_e of the callback, or of the parser if it was not called. */
+  uint8_t valid; /* Bit i is set if argument i was given. */
+  uint8_t args[UCMD_TRACE_ARGS][UCMD_ARG_BYTES_MAX_SIZE];
+} uCmdTraceRec_s;
+
+/* Last UCMD_TRACE_DEPTH commands run by an instance. Storage is provided by the
+ * caller, see uCmd_SetTrace; defined as a global, it can be read by a debugger
+ * or from a RAM dump: the newest record is rec[(cnt - 1) % UCMD_TRACE_DEPTH].
+ * Only the main loop writes it. */
+typedef struct uCmdTrace {
+  uCmdTraceRec_s rec[UCMD_TRACE_DEPTH];
+  uint32_t cnt; /* Commands recorded since init. */
+} uCmdTrace_s;
+#endif
+
 typedef struct uCmdTable {
   const uCmdInfo_s* info_a;
   size_t size;
+  const uCmdHash_s* hash; /* NULL falls back to a linear scan. */
+  const uCmdArgIdx_s* argidx; /* One per command. NULL falls back to a linear scan. */
+#if UCMD_PACKED
+  const uCmdPacked_s* packed; /* Set instead of info_a for a packed table. */
+  const uint16_t* nameofs; /* Per command offsets into its pools. */
+  const uint16_t* argofs;
+#endif
+#if UCMD_STATS
+  uCmdStats_s* stats; /* NULL if not counted. */
+#endif
 } uCmdTable_s;
 
 typedef struct uCmdHandle {
    CallbackPtr_t callback;
    Arg_s args[UCMD_ARG_MAX_SIZE];
    void* userarg;
+   uint16_t cmd; /* Index of the command resolved by the parser. */
+#if UCMD_STATS || UCMD_TRACE
+   const uCmdTable_s* table; /* Table it was looked up in, set even if the line fails. */
+#endif
 } uCmdHandle_s;
 
+/* One command interpreter. Storage is provided by the caller, members are private.
+ * Instances share no state, so each one can serve its own channel and table. */
+typedef struct uCmdCtx {
+  uCmdTable_s table;
+#if UCMD_HASH_DISPATCH
+  uCmdHash_s hash;
+#endif
+  uCmdArgIdx_s argidx[UCMD_TABLE_MAX_SIZE];
+#if UCMD_PACKED
+  uint16_t nameofs[UCMD_TABLE_MAX_SIZE];
+  uint16_t argofs[UCMD_TABLE_MAX_SIZE];
+#endif
+#if UCMD_STREAM
+  uint16_t order[UCMD_TABLE_MAX_SIZE]; /* Command indexes sorted by name. */
+  uint16_t ordercnt;
+#endif
+#if UCMD_LATENCY
+  uCmdLatency_s latency; /* mean is only filled in copies. */
+  uint64_t latsum;
+  uint32_t stamp; /* Completion time of the line being run, valid if stamped. */
+  uint8_t stamped;
+#endif
+#if UCMD_TRACE
+  uCmdTrace_s* trace; /* NULL if not recorded. */
+#endif
+} uCmdCtx_s;
+
+#if UCMD_STREAM
+/* Command resolved by the character-level parser, waiting for dispatch. */
+typedef struct uCmdStreamCmd {
+  uCmdHandle_s handle;
+  const uCmdTable_s* table; /* Table the command was found in. */
+  ErrCode_e ret; /* First error found in the line, the command is not run. */
+} uCmdStreamCmd_s;
+
+/* Character-level parser. Storage is provided by the caller, members are private.
+ * Characters are fed from the receiving context, resolved commands are run from
+ * the main loop; the queue between them follows the Line queue rules. */
+typedef struct uCmdStream {
+  uCmdStreamCmd_s slot[UCMD_STREAM_QUEUE_DEPTH];
+  LineIdx_t head; /* Number of commands resolved. Only the producer writes it. */
+  LineIdx_t tail; /* Number of commands run. Only the consumer writes it. */
+  volatile uint16_t drops; /* Commands dropped as the queue was full. */
+  const uCmdCtx_s* level; /* Table the current word is looked up in. */
+  uint8_t state;
+  uint8_t namelen; /* Command name characters so far. */
+  uint16_t lo; /* Range of sorted names matching them. */
+  uint16_t hi;
+  uint8_t argslot; /* Descriptor of the argument being received. */
+  uint8_t neg;
+  uint8_t digits;
+  uint64_t acc; /* Magnitude, saturated past UINT32_MAX. */
+} uCmdStream_s;
+#endif
+
+#if UCMD_FRAME
+/* Binary frame, for hosts that do not need to type commands:
+ *
+ *   sync | cmd (2) | len | args (len) | crc (2)
+ *
+ * cmd is the index of the command in the table and len the number of argument
+ * bytes. Arguments follow the order of the command descriptors, each one at
+ * the width of its type; the first ones may be given alone, as with named
+ * arguments left out. The CRC-16/CCITT-FALSE covers cmd, len and args. Fields
+ * wider than a byte are little-endian. */
+#define UCMD_FRAME_SYNC (0xA5)
+#define UCMD_FRAME_HEAD_SIZE (4)
+#define UCMD_FRAME_CRC_SIZE (2)
+#define UCMD_FRAME_ARGS_MAX_SIZE (UCMD_ARG_MAX_SIZE * UCMD_ARG_BYTES_MAX_SIZE)
+#define UCMD_FRAME_MAX_SIZE (UCMD_FRAME_HEAD_SIZE + UCMD_FRAME_ARGS_MAX_SIZE + UCMD_FRAME_CRC_SIZE)
+
+/* Frame receiver. Storage is provided by the caller, members are private.
+ * Bytes are fed from the receiving context, which checks the CRC; complete
+ * frames are run from the main loop, with the Line queue rules. */
+typedef struct uCmdFrame {
+  uint8_t buff[UCMD_FRAME_QUEUE_DEPTH][UCMD_FRAME_MAX_SIZE];
+  LineIdx_t head; /* Number of frames received. Only the producer writes it. */
+  LineIdx_t tail; /* Number of frames run. Only the consumer writes it. */
+  volatile uint16_t drops; /* Frames dropped as the queue was full. */
+  volatile uint16_t errs; /* Frames dropped on a bad length or CRC. */
+  uint8_t cnt; /* Bytes of the frame being received. */
+  uint8_t len; /* Its argument bytes. */
+  uint8_t skip; /* The queue was full when it started, it is not stored. */
+} uCmdFrame_s;
+#endif
+
+/* Argument descriptors are checked here: names must be unique within a command
+ * and in [0-9A-Za-z], types numeric and bound sizes must match the type. Tables
+ * of more than UCMD_TABLE_MAX_SIZE commands return E_INV_SIZE. A table that
+ * fails is not installed. */
 ErrCode_e uCmd_InitTable(const uCmdInfo_s* cmdtable, size_t table_sz);
 
 ErrCode_e uCmd_Run(const char* cmdstr);
 
+/* Callback of UCMD_SUBTABLE entries. The parser never calls it: a line that
+ * ends on a sub-table name fails as an unknown command, E_INTERNAL. */
+ErrCode_e uCmd_SubTable(Arg_s* args, void* usrargs);
+
 ErrCode_e uCmd_Loop(void);
 
+/* Same as above on a given instance. uCmd_ functions use a default instance
+ * fed by the default Line instance. */
+ErrCode_e uCmdCtx_InitTable(uCmdCtx_s* ctx, const uCmdInfo_s* cmdtable, size_t table_sz);
+
+ErrCode_e uCmdCtx_Run(uCmdCtx_s* ctx, const char* cmdstr);
+
+ErrCode_e uCmdCtx_Loop(uCmdCtx_s* ctx, LineCtx_s* line);
+
+#if UCMD_PACKED
+/* Same as uCmd_InitTable for a packed table. The pools must match the command
+ * list exactly, and the table hold at most UCMD_TABLE_MAX_SIZE commands. */
+ErrCode_e uCmd_InitPacked(const uCmdPacked_s* table);
+
+ErrCode_e uCmdCtx_InitPacked(uCmdCtx_s* ctx, const uCmdPacked_s* table);
+#endif
+
+#if UCMD_REGISTRY
+/* Same as uCmd_InitTable for the commands declared with UCMD_REGISTER. They
+ * come in link order, so a name registered twice is rejected with E_INV_ARG.
+ * E_INV_SIZE if no command is registered. */
+ErrCode_e uCmd_InitRegistered(void);
+
+ErrCode_e uCmdCtx_InitRegistered(uCmdCtx_s* ctx);
+#endif
+
+#if UCMD_STREAM
+/* Character-level parser, an alternative to Line plus uCmd_Loop. Each character
+ * received is fed to uCmd_StreamChar, which resolves the command and converts
+ * its arguments as they arrive. At the end of line the command is queued fully
+ * resolved, and uCmd_StreamLoop only has to call it. Lines follow the Line
+ * rules: CR or LF ends them, blanks at their start are skipped. The default
+ * parser is reset by uCmd_InitTable; others need uCmdStream_Init after their
+ * table changes. It runs the table uCmd_Run runs: while none is installed, as
+ * after a table rejected for its size, both functions return E_NOT_INITIALIZED. */
+void uCmdStream_Init(uCmdStream_s* stream);
+
+ErrCode_e uCmd_StreamChar(char ch);
+
+/* Runs the oldest resolved command and returns its result, E_OK if none. */
+ErrCode_e uCmd_StreamLoop(void);
+
+ErrCode_e uCmdCtx_StreamChar(const uCmdCtx_s* ctx, uCmdStream_s* stream, char ch);
+
+ErrCode_e uCmdCtx_StreamLoop(const uCmdCtx_s* ctx, uCmdStream_s* stream);
+
+uint16_t uCmd_GetStreamDropCnt(void);
+
+uint16_t uCmdStream_GetDropCnt(const uCmdStream_s* stream);
+#endif
+
+#if UCMD_FRAME
+/* Runs one complete binary frame of frame_sz bytes. The sync byte, length and
+ * CRC are checked (E_INV_SIZE, E_INV_ARG), an unknown command index fails as
+ * an unknown name (E_INTERNAL). Sub-table entries cannot be reached. */
+ErrCode_e uCmd_RunFrame(const uint8_t* frame, size_t frame_sz);
+
+/* Frame receiver, fed one byte at a time. Bytes before a sync byte are
+ * skipped, and a frame with a bad length or CRC is dropped as a whole. The
+ * default receiver is reset by uCmd_InitTable. */
+void uCmdFrame_Init(uCmdFrame_s* frame);
+
+void uCmd_FrameByte(uint8_t byte);
+
+/* Runs the oldest received frame and returns its result, E_OK if none. */
+ErrCode_e uCmd_FrameLoop(void);
+
+uint16_t uCmd_GetFrameDropCnt(void);
+
+uint16_t uCmd_GetFrameErrCnt(void);
+
+void uCmdFrame_AddByte(uCmdFrame_s* frame, uint8_t byte);
+
+ErrCode_e uCmdCtx_RunFrame(const uCmdCtx_s* ctx, const uint8_t* frame, size_t frame_sz);
+
+ErrCode_e uCmdCtx_FrameLoop(const uCmdCtx_s* ctx, uCmdFrame_s* frame);
+
+uint16_t uCmdFrame_GetDropCnt(const uCmdFrame_s* frame);
+
+uint16_t uCmdFrame_GetErrCnt(const uCmdFrame_s* frame);
+
+/* Builds the frame of command cmd around args_sz bytes of arguments, as a
+ * host would. frame_sz receives its size. */
+ErrCode_e uCmdFrame_Encode(uint8_t* buf, size_t buf_sz, uint16_t cmd, const uint8_t* args, size_t args_sz,
+                           size_t* frame_sz);
+#endif
+
+#if UCMD_CLOCK
+/* Clock of the time histograms and of the latencies, shared by all instances
+ * and by the Line stamps. Without one, only the counts are kept. */
+void uCmd_SetClock(uCmd_Clock clock);
+#endif
+
+#if UCMD_STATS
+/* Clears every counter. */
+void uCmdStats_Init(uCmdStats_s* stats);
+
+/* Starts counting the lines run on the installed table into stats, NULL stops.
+ * Installing a table detaches the counters: attach them after it, or get
+ * E_NOT_INITIALIZED. Commands reached through UCMD_SUBTABLE are counted by the
+ * sub-table instance, if it has counters of its own. */
+ErrCode_e uCmd_SetStats(uCmdStats_s* stats);
+
+ErrCode_e uCmdCtx_SetStats(uCmdCtx_s* ctx, uCmdStats_s* stats);
+
+/* Counters of command idx. UCMD_STATS_UNKNOWN, or any larger index, gives the
+ * lines whose name was not found, and those of commands past the last slot. */
+const uCmdStatsCmd_s* uCmdStats_GetCmd(const uCmdStats_s* stats, size_t idx);
+
+/* Callback of UCMD_STATS_CMD. The report goes to the default Tx instance, which
+ * may drop the end of it if its drain is too slow: E_TOO_LARGE is returned then. */
+ErrCode_e uCmd_Stats(Arg_s* args, void* usrargs);
+#endif
+
+#if UCMD_LATENCY
+/* Latency of the lines run by uCmd_Loop since the last reset; lines run by
+ * uCmd_Run alone have no completion time. All zero until one is measured.
+ * Installing a table resets them. */
+ErrCode_e uCmd_GetLatency(uCmdLatency_s* latency);
+
+void uCmd_ResetLatency(void);
+
+ErrCode_e uCmdCtx_GetLatency(const uCmdCtx_s* ctx, uCmdLatency_s* latency);
+
+void uCmdCtx_ResetLatency(uCmdCtx_s* ctx);
+#endif
+
+#if UCMD_TRACE
+/* Clears every record. */
+void uCmdTrace_Init(uCmdTrace_s* trace);
+
+/* Starts recording the lines, text or frames, run on the instance into trace,
+ * NULL stops. Installing a table detaches the trace: attach it after it, or get
+ * E_NOT_INITIALIZED. */
+ErrCode_e uCmd_SetTrace(uCmdTrace_s* trace);
+
+ErrCode_e uCmdCtx_SetTrace(uCmdCtx_s* ctx, uCmdTrace_s* trace);
+
+/* Record of the command run age commands ago, 0 being the newest. NULL if it
+ * was not recorded or has been overwritten. */
+const uCmdTraceRec_s* uCmdTrace_Get(const uCmdTrace_s* trace, size_t age);
+
+/* Callback of UCMD_TRACE_CMD. One line per record, "t=<time> c=<cmd> r=<ret>"
+ * followed by "<i>=<hex>" for each argument given. Commands of sub-tables are
+ * given with the indexes of the sub-table entries that lead to them, as in
+ * "c=1.0.2"; "c=?.2" if their table is no longer reached from the instance.
+ * The records are written to the default Tx instance, one at a time:
+ * E_TOO_LARGE is returned if one of them is dropped. */
+ErrCode_e uCmd_Trace(Arg_s* args, void* usrargs);
+#endif
+
 #endif
@@ -0,0 +1,178 @@
+#ifndef UCMD_CONFIG_H
+#define UCMD_CONFIG_H
+
+/* Build time sizing of uCmd and Line. Every value below can be overridden on
+ * the compiler command line (-DUCMD_TABLE_MAX_SIZE=1024), or from a project
+ * header named by UCMD_CONFIG_FILE (-DUCMD_CONFIG_FILE='"app_ucmd_config.h"'),
+ * which is read first. Combinations that cannot work stop the build. */
+#ifdef UCMD_CONFIG_FILE
+#include UCMD_CONFIG_FILE
+#endif
+
+/* Command tables. Instances keep per command indexes, so RAM grows with
+ * UCMD_TABLE_MAX_SIZE; uCmd_InitTable rejects larger tables with E_INV_SIZE. */
+#ifndef UCMD_TABLE_MAX_SIZE
+#define UCMD_TABLE_MAX_SIZE (8) // Maximum number of callbacks.
+#endif
+#ifndef UCMD_ARG_MAX_SIZE
+#define UCMD_ARG_MAX_SIZE (4) // Maximum number of arguments per command.
+#endif
+#ifndef UCMD_NAME_MAX_SIZE
+#define UCMD_NAME_MAX_SIZE (16) // Maximum string length of callback name.
+#endif
+
+/* Received lines. Lines are parsed in place, so the raw string buffer and the
+ * Line buffer are the same size: set either one and the other follows. */
+#if defined(UCMD_RAW_STR_MAX_SIZE) && !defined(LINE_MAX_STR_LEN)
+#define LINE_MAX_STR_LEN (UCMD_RAW_STR_MAX_SIZE - 1)
+#endif
+#ifndef LINE_MAX_STR_LEN
+#define LINE_MAX_STR_LEN (64) // Maximum number of characters in a line.
+#endif
+#define LINE_BUFF_SIZE (LINE_MAX_STR_LEN + 1)
+#ifndef UCMD_RAW_STR_MAX_SIZE
+#define UCMD_RAW_STR_MAX_SIZE (LINE_BUFF_SIZE) // Max. size of buffer that holds raw data.
+#endif
+#ifndef LINE_QUEUE_DEPTH
+#define LINE_QUEUE_DEPTH (4) // Number of complete lines that can wait to be processed.
+                             // A depth of 2 makes a ping-pong buffer: one line is
+                             // processed in place while the other one is received.
+#endif
+
+/* Replies. The ring holds bytes written by the main loop until the drain hook
+ * sends them, so it should cover the longest burst of replies. */
+#ifndef TX_BUFF_SIZE
+#define TX_BUFF_SIZE (256) // Bytes waiting to be sent. Power of two.
+#endif
+
+/* Optional parts. */
+#ifndef UCMD_HASH_DISPATCH
+#define UCMD_HASH_DISPATCH (1) // Build a perfect hash over command names on init.
+#endif
+#ifndef UCMD_HASH_BUCKET_MAX_SIZE
+#define UCMD_HASH_BUCKET_MAX_SIZE (16) // Max. number of names sharing a first level bucket.
+#endif
+#ifndef UCMD_PACKED
+#define UCMD_PACKED (1) // Accept packed tables, at the cost of two offsets per command in RAM.
+#endif
+#ifndef UCMD_REGISTRY
+#if defined(__GNUC__)
+#define UCMD_REGISTRY (1) // Gather commands declared with UCMD_REGISTER from a linker section.
+#else
+#define UCMD_REGISTRY (0)
+#endif
+#endif
+#ifndef UCMD_STREAM
+#define UCMD_STREAM (1) // Keep a sorted name index for the character-level parser.
+#endif
+#ifndef UCMD_STREAM_QUEUE_DEPTH
+#define UCMD_STREAM_QUEUE_DEPTH (4) // Commands resolved ahead of dispatch. Power of two.
+#endif
+#ifndef UCMD_FRAME
+#define UCMD_FRAME (1) // Binary frames, decoded against the same tables.
+#endif
+#ifndef UCMD_FRAME_QUEUE_DEPTH
+#define UCMD_FRAME_QUEUE_DEPTH (4) // Complete frames waiting for dispatch. Power of two.
+#endif
+#ifndef UCMD_STATS
+#define UCMD_STATS (0) // Per command counts and timings, about 180 bytes of RAM per command.
+#endif
+#ifndef UCMD_STATS_BUCKETS
+#define UCMD_STATS_BUCKETS (16) // Log2 time buckets, the last one takes all longer times.
+#endif
+#ifndef UCMD_LATENCY
+#define UCMD_LATENCY (0) // Time from line completion to callback start, 4 bytes per queued line.
+#endif
+#ifndef UCMD_TRACE
+#define UCMD_TRACE (0) // Ring of the last commands run, with their arguments and results.
+#endif
+#ifndef UCMD_TRACE_DEPTH
+#define UCMD_TRACE_DEPTH (16) // Commands kept. Power of two.
+#endif
+#ifndef UCMD_TRACE_ARGS
+#if UCMD_ARG_MAX_SIZE < 8
+#define UCMD_TRACE_ARGS (UCMD_ARG_MAX_SIZE) // Leading arguments kept per command.
+#else
+#define UCMD_TRACE_ARGS (8)
+#endif
+#endif
+/* Parts that read the uCmd_SetClock clock. */
+#define UCMD_CLOCK (UCMD_STATS || UCMD_LATENCY || UCMD_TRACE)
+
+/* Checks that only need the preprocessor. Those on type sizes are static
+ * assertions in the sources. */
+#if (UCMD_TABLE_MAX_SIZE < 1) || (UCMD_TABLE_MAX_SIZE > 0x7FFF)
+#error "UCMD_TABLE_MAX_SIZE must be between 1 and 32767, the hash slot index is 15 bits."
+#endif
+
+/* Argument names are single characters in [0-9A-Za-z]. */
+#if (UCMD_ARG_MAX_SIZE < 1) || (UCMD_ARG_MAX_SIZE > 62)
+#error "UCMD_ARG_MAX_SIZE must be between 1 and 62."
+#endif
+
+/* The character-level parser counts name characters on a byte. */
+#if (UCMD_NAME_MAX_SIZE < 1) || (UCMD_NAME_MAX_SIZE > 254)
+#error "UCMD_NAME_MAX_SIZE must be between 1 and 254."
+#endif
+
+#if (LINE_MAX_STR_LEN < 1) || (LINE_BUFF_SIZE > 0xFFFF)
+#error "LINE_MAX_STR_LEN must be between 1 and 65534, lines are counted on 16 bits."
+#endif
+
+#if UCMD_RAW_STR_MAX_SIZE != LINE_BUFF_SIZE
+#error "UCMD_RAW_STR_MAX_SIZE must be LINE_MAX_STR_LEN + 1, set only one of them."
+#endif
+
+#if (LINE_QUEUE_DEPTH < 1) || (LINE_QUEUE_DEPTH > 128) || (LINE_QUEUE_DEPTH & (LINE_QUEUE_DEPTH - 1))
+#error "LINE_QUEUE_DEPTH must be a power of two between 1 and 128."
+#endif
+
+#if (TX_BUFF_SIZE < 2) || (TX_BUFF_SIZE > 0x8000) || (TX_BUFF_SIZE & (TX_BUFF_SIZE - 1))
+#error "TX_BUFF_SIZE must be a power of two between 2 and 32768, ring positions are 16 bits."
+#endif
+
+/* Seeds above the bucket size select slots, up to the 15 bit limit. */
+#if (UCMD_HASH_BUCKET_MAX_SIZE < 1) || (UCMD_HASH_BUCKET_MAX_SIZE > 0x7FFE)
+#error "UCMD_HASH_BUCKET_MAX_SIZE must be between 1 and 32766."
+#endif
+
+/* Section placement relies on GCC attributes and on the ELF linkers, which
+ * define __start_ and __stop_ symbols around sections named as C identifiers. */
+#if UCMD_REGISTRY && !defined(__GNUC__)
+#error "UCMD_REGISTRY needs GCC or Clang."
+#endif
+
+#if (UCMD_STREAM_QUEUE_DEPTH < 1) || (UCMD_STREAM_QUEUE_DEPTH > 128) || \
+    (UCMD_STREAM_QUEUE_DEPTH & (UCMD_STREAM_QUEUE_DEPTH - 1))
+#error "UCMD_STREAM_QUEUE_DEPTH must be a power of two between 1 and 128."
+#endif
+
+#if (UCMD_FRAME_QUEUE_DEPTH < 1) || (UCMD_FRAME_QUEUE_DEPTH > 128) || \
+    (UCMD_FRAME_QUEUE_DEPTH & (UCMD_FRAME_QUEUE_DEPTH - 1))
+#error "UCMD_FRAME_QUEUE_DEPTH must be a power of two between 1 and 128."
+#endif
+
+#if (UCMD_STATS_BUCKETS < 2) || (UCMD_STATS_BUCKETS > 33)
+#error "UCMD_STATS_BUCKETS must be between 2 and 33, times are counted in 32-bit ticks."
+#endif
+
+#if (UCMD_TRACE_DEPTH < 1) || (UCMD_TRACE_DEPTH > 0x8000) || (UCMD_TRACE_DEPTH & (UCMD_TRACE_DEPTH - 1))
+#error "UCMD_TRACE_DEPTH must be a power of two between 1 and 32768."
+#endif
+
+/* Given arguments are flagged in a byte. */
+#if (UCMD_TRACE_ARGS < 1) || (UCMD_TRACE_ARGS > 8) || (UCMD_TRACE_ARGS > UCMD_ARG_MAX_SIZE)
+#error "UCMD_TRACE_ARGS must be between 1 and 8, and at most UCMD_ARG_MAX_SIZE."
+#endif
+
+/* Compile time assertion on constant expressions, sizeof included. */
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+#define UCMD_STATIC_ASSERT(_cond, _msg) _Static_assert((_cond), _msg)
+#else
+#define _UCMD_CAT2(_a, _b) _a##_b
+#define _UCMD_CAT(_a, _b) _UCMD_CAT2(_a, _b)
+#define UCMD_STATIC_ASSERT(_cond, _msg) \
+  typedef char _UCMD_CAT(ucmd_static_assert_, __LINE__)[(_cond) ? 1 : -1]
+#endif
+
+#endif
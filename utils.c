@@ -11,9 +11,27 @@
 #define UTILS_CHAR_ZERO 48
 #define UTILS_CHAR_NINE 57
 
-#define UTILS_STR_MAX_U32 "4294967295"
-#define UTILS_STR_MIN_I32 "2147483648" // Sign is omitted.
-#define UTILS_STR_MAX_I32 "2147483647"
+#define UTILS_MAX_U32 (4294967295u)
+#define UTILS_MIN_I32 (2147483648u) // Sign is omitted.
+#define UTILS_MAX_I32 (2147483647u)
+
+/* Digits are converted several at a time within a register (SWAR): a block
+ * of ASCII digits is loaded as one little-endian word, checked and combined
+ * with a few multiplies instead of one multiply per digit. */
+#ifndef UTILS_SWAR
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define UTILS_SWAR (1)
+#else
+#define UTILS_SWAR (0)
+#endif
+#endif
+
+/* Blocks of 8 digits need 64-bit arithmetic, 32-bit targets stay at 4. */
+#if UTILS_SWAR && (UINTPTR_MAX > 0xFFFFFFFFu)
+#define UTILS_SWAR_8 (1)
+#else
+#define UTILS_SWAR_8 (0)
+#endif
 
 #ifndef TEST_UTILS
 #undef assert
@@ -79,46 +97,126 @@ ErrCode_e findch(const char* str, uint8_t ch, int16_t* idx) {
 }
 
 ErrCode_e strtoi32(const char* rawstr, int32_t* data) {
+  return strntoi32(rawstr, rawstr ? strlen(rawstr) : 0, data);
+}
+
+ErrCode_e strtou32(const char* rawstr, uint32_t* data) {
+  return strntou32(rawstr, rawstr ? strlen(rawstr) : 0, data);
+}
+
+#if UTILS_SWAR_8
+/* Value of 8 ASCII digits, or a value above 99999999 if any is not a digit. */
+static inline uint32_t _swar_digits8(const char* str) {
+  uint64_t val;
+  memcpy(&val, str, sizeof(val));
+  val -= 0x3030303030303030ull;
+  /* A byte outside '0'..'9' either borrows or reaches 0x80 once 0x76 is added. */
+  if(((val | (val + 0x7676767676767676ull)) & 0x8080808080808080ull) != 0) {
+    return UINT32_MAX;
+  }
+  val = (val * 10) + (val >> 8);
+  return (uint32_t)((((val & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) +
+                    (((val >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32);
+}
+#endif
+
+#if UTILS_SWAR
+/* Value of 4 ASCII digits, or a value above 9999 if any is not a digit. */
+static inline uint32_t _swar_digits4(const char* str) {
+  uint32_t val;
+  memcpy(&val, str, sizeof(val));
+  val -= 0x30303030u;
+  if(((val | (val + 0x76767676u)) & 0x80808080u) != 0) {
+    return UINT32_MAX;
+  }
+  val = (val * 10) + (val >> 8);
+  return ((val & 0x00FF00FFu) * (1 + (100u << 16))) >> 16;
+}
+#endif
+
+/* Unsigned value of the first slen characters, which must all be digits.
+   The value is checked against max after each block, while it still fits
+   in 64 bits, so neither leading zeros nor long strings can wrap it. An
+   invalid character sets it above any max, which ends all loops. */
+static inline ErrCode_e _strntodec(const char* str, size_t slen, uint32_t max, uint32_t* data) {
+  ErrCode_e ret = E_OUT_OF_RANGE;
+  uint64_t acc = 0;
+  uint32_t blk;
+  size_t i = 0;
+#if UTILS_SWAR
+  /* Short numbers, the most common ones, go straight to the digit loop. */
+  if(slen >= 4) {
+#if UTILS_SWAR_8
+    for(; ((i + 8) <= slen) && (acc <= max); i += 8) {
+      blk = _swar_digits8(&str[i]);
+      acc = (blk <= 99999999u) ? (acc * 100000000u) + blk : UINT64_MAX;
+    }
+#endif
+    for(; ((i + 4) <= slen) && (acc <= max); i += 4) {
+      blk = _swar_digits4(&str[i]);
+      acc = (blk <= 9999u) ? (acc * 10000u) + blk : UINT64_MAX;
+    }
+  }
+#endif
+  for(; (i < slen) && (acc <= max); i++) {
+    blk = (uint32_t)(uint8_t)str[i] - UTILS_CHAR_ZERO;
+    acc = (blk <= 9u) ? (acc * 10u) + blk : UINT64_MAX;
+  }
+  if(acc <= max) {
+    *data = (uint32_t)acc;
+    ret = E_OK;
+  }
+  return ret;
+}
+
+ErrCode_e strntoi32(const char* rawstr, size_t slen, int32_t* data) {
   ErrCode_e ret = E_GENERIC;
-  size_t slen;
-  int32_t k = 1;
-  const char* ofs = rawstr;
-  if((rawstr) && (data) && (slen = strlen(rawstr)))
+  uint8_t neg = 0;
+  uint32_t mag = 0;
+  if((rawstr) && (data) && (slen))
   {
+    *data = 0;
     if(rawstr[0] == '-') {
-      k = -1;
-      ofs = rawstr + 1;
+      neg = 1;
+      rawstr++;
+      slen--;
+    }
+    ret = slen ? _strntodec(rawstr, slen, neg ? UTILS_MIN_I32 : UTILS_MAX_I32, &mag) : E_INV_SIZE;
+    if(ret == E_OK) {
+      /* Negated after the cast, as the magnitude of INT32_MIN has no int32_t. */
+      *data = (neg && mag) ? -(int32_t)(mag - 1u) - 1 : (int32_t)mag;
     }
-    ret = strtou32(ofs, (uint32_t*)data);
-    *data *= k;
   } else {
     ret = (rawstr && data) ? E_INV_SIZE : E_NULL_PTR;
   }
   return ret;
 }
 
-ErrCode_e strtou32(const char* rawstr, uint32_t* data) {
-  size_t i;
+ErrCode_e strntou32(const char* rawstr, size_t slen, uint32_t* data) {
   ErrCode_e ret = E_GENERIC;
-  int8_t tmp = 0;
-  size_t slen;
-  if((rawstr) && (data) && (slen = strlen(rawstr))) {
-    ret = E_OK;
+  if((rawstr) && (data) && (slen)) {
     *data = 0;
-    for(i = 0; (i < slen) && ((rawstr[i] >= UTILS_CHAR_ZERO) && rawstr[i] <= UTILS_CHAR_NINE); i++) {
-      tmp = rawstr[i] - (uint8_t)UTILS_CHAR_ZERO;
-      *data = tmp + 10 * (*data);
-    }
-    if( i < slen) {
-      /* For loop broke due to invalid char in string. */
-      ret = E_OUT_OF_RANGE;
-    }
+    /* Invalid characters and values above UINT32_MAX are both out of range. */
+    ret = _strntodec(rawstr, slen, UTILS_MAX_U32, data);
   } else {
     ret = (rawstr && data) ? E_INV_SIZE : E_NULL_PTR;
   }
   return ret;
 }
 
+/* Polynomial 0x1021, one byte per step without a table: the byte is folded
+   into the top of the register and its two nibbles are reduced at once. */
+uint16_t crc16(uint16_t crc, const uint8_t* data, size_t len) {
+  uint8_t x;
+  size_t i;
+  for(i = 0; data && (i < len); i++) {
+    x = (uint8_t)((crc >> 8) ^ data[i]);
+    x ^= (uint8_t)(x >> 4);
+    crc = (uint16_t)((crc << 8) ^ ((uint16_t)x << 12) ^ ((uint16_t)x << 5) ^ x);
+  }
+  return crc;
+}
+
 ErrCode_e strtof(const char* rawstr, float* data) {
    size_t i;
    ErrCode_e ret = E_GENERIC;
@@ -2,6 +2,7 @@
 #define UTILS_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include "err.h"
 
 ErrCode_e tobytes(uint8_t* buf, size_t bufsz, void* data, size_t datasz);
@@ -9,5 +10,14 @@ ErrCode_e frombytes(uint8_t* buf, size_t bufsz, void* data, size_t datasz);
 ErrCode_e findch(const char* str, uint8_t ch, int16_t* idx);
 ErrCode_e strtou32(const char* rawstr, uint32_t* data);
 ErrCode_e strtoi32(const char* rawstr, int32_t* data);
+/* Same as above, on the first slen characters of a string that needs not be
+   null-terminated. */
+ErrCode_e strntou32(const char* rawstr, size_t slen, uint32_t* data);
+ErrCode_e strntoi32(const char* rawstr, size_t slen, int32_t* data);
+
+#define CRC16_INIT (0xFFFF)
+/* CRC-16/CCITT-FALSE of len bytes, started from CRC16_INIT or carried on from
+   a previous result. */
+uint16_t crc16(uint16_t crc, const uint8_t* data, size_t len);
 
 #endif